@@ -0,0 +1,123 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "gravityKernel.hpp"
+
+/**
+ * Measure the direct gravity kernel in interactions per second on one thread,
+ * for each instruction set, so that its regressions show up
+*/
+
+namespace {
+
+/**
+ * The number of interactions timed for each configuration, at least one full pass
+*/
+const static double kNbInteractions = 4e8;
+
+/**
+ * The softening length of the cluster
+*/
+const static GLfloat kSoftening = 0.01f;
+
+/**
+ * A cluster as a structure of arrays
+*/
+struct Cluster{
+    std::vector<GLfloat> _X, _Y, _Z, _Masses;
+    std::vector<GLfloat> _AccelerationsX, _AccelerationsY, _AccelerationsZ;
+
+    GravityBatch getBatch(){
+        return GravityBatch{
+            (GLuint)_Masses.size(), _X.data(), _Y.data(), _Z.data(), _Masses.data(),
+            _AccelerationsX.data(), _AccelerationsY.data(), _AccelerationsZ.data()
+        };
+    }
+};
+
+GLfloat randomRange(GLfloat min, GLfloat max){
+    return min + (max - min) * (rand() / (GLfloat)RAND_MAX);
+}
+
+/**
+ * Create a uniform ball of bodies of equal masses
+ * @param nbBodies The number of bodies
+ * @param cluster Filled with the bodies
+*/
+void createCluster(GLuint nbBodies, Cluster& cluster){
+    for(GLuint i=0; i<nbBodies; i++){
+        GLfloat x, y, z;
+        do {
+            x = randomRange(-1.0f, 1.0f);
+            y = randomRange(-1.0f, 1.0f);
+            z = randomRange(-1.0f, 1.0f);
+        } while(x*x + y*y + z*z > 1.0f);
+        cluster._X.push_back(x);
+        cluster._Y.push_back(y);
+        cluster._Z.push_back(z);
+        cluster._Masses.push_back(1.0f / nbBodies);
+    }
+    cluster._AccelerationsX.assign(nbBodies, 0.0f);
+    cluster._AccelerationsY.assign(nbBodies, 0.0f);
+    cluster._AccelerationsZ.assign(nbBodies, 0.0f);
+}
+
+/**
+ * Get the largest error of the accelerations against a sum in double precision, on a sample of bodies
+ * @param cluster The bodies and their computed accelerations
+ * @return The largest relative error
+*/
+double maxError(const Cluster& cluster){
+    const GLuint nbBodies = cluster._Masses.size();
+    double error = 0.0;
+    for(GLuint i=0; i<nbBodies; i+=std::max(1u, nbBodies/64)){
+        double ax = 0.0, ay = 0.0, az = 0.0;
+        for(GLuint j=0; j<nbBodies; j++){
+            double dx = cluster._X[j] - cluster._X[i], dy = cluster._Y[j] - cluster._Y[i], dz = cluster._Z[j] - cluster._Z[i];
+            double r2 = dx*dx + dy*dy + dz*dz + kSoftening*kSoftening;
+            double strength = cluster._Masses[j] / (r2 * std::sqrt(r2));
+            ax += strength * dx;
+            ay += strength * dy;
+            az += strength * dz;
+        }
+        double ex = cluster._AccelerationsX[i] - ax, ey = cluster._AccelerationsY[i] - ay, ez = cluster._AccelerationsZ[i] - az;
+        error = std::max(error, std::sqrt((ex*ex + ey*ey + ez*ez) / (ax*ax + ay*ay + az*az)));
+    }
+    return error;
+}
+
+}
+
+int main(int argc, char** argv){
+    const GLuint sizes[] = {1000, 4000, 16000};
+    const char* levelNames[] = {"scalar", "sse", "avx2"};
+    printf("best instruction set: %s\n\n", levelNames[detectSimdLevel()]);
+    printf("%10s %10s %22s %14s\n", "bodies", "level", "interactions / s", "max error");
+
+    for(GLuint nbBodies : sizes){
+        srand(42);
+        Cluster cluster;
+        createCluster(nbBodies, cluster);
+        GravityBatch batch = cluster.getBatch();
+        const double interactions = (double)nbBodies * nbBodies;
+        const int nbPasses = std::max(1, (int)(kNbInteractions / interactions));
+
+        for(int level=SIMD_SCALAR; level<=SIMD_AVX2; level++){
+            if(level > detectSimdLevel()){
+                printf("%10u %10s %22s %14s\n", nbBodies, levelNames[level], "n/a", "n/a");
+                continue;
+            }
+            auto start = std::chrono::steady_clock::now();
+            for(int pass=0; pass<nbPasses; pass++){
+                computeGravity(batch, 1.0f, kSoftening, 0, nbBodies, (SimdLevel)level);
+            }
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            printf("%10u %10s %22.4g %14.3g\n", nbBodies, levelNames[level], interactions * nbPasses / elapsed.count(), maxError(cluster));
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,222 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/ext.hpp>
+
+#include "transformKernel.hpp"
+
+/**
+ * Compare the batched transform kernel with the former per planet update,
+ * on a hierarchy of suns, planets and moons
+*/
+
+namespace {
+
+/**
+ * The number of frames timed for each configuration
+*/
+const static int kNbFrames = 20;
+
+/**
+ * A planet as it used to be updated: its own heap object with a pointer to its orbit center
+*/
+struct LegacyPlanet{
+    LegacyPlanet* _OrbitCenter = nullptr;
+    GLfloat _OrbitSpeed = 0.0f;
+    GLfloat _OrbitRadius = 0.0f;
+    glm::vec3 _OrbitAxis = glm::vec3(0.f, 1.f, 0.f);
+    GLfloat _RotationSpeed = 0.0f;
+    glm::vec3 _RotationAxis = glm::vec3(0.f, 1.f, 0.f);
+    GLfloat _Size = 1.0f;
+    glm::mat4 _Model = glm::mat4(1.0f);
+
+    /**
+     * The former update: five generic transforms and three matrix products per planet
+     * @param time The simulation time
+    */
+    void update(GLfloat time){
+        _Model = glm::scale(glm::mat4(1.0f), glm::vec3(_Size));
+        _Model = glm::rotate(_Model, _RotationSpeed*time, _RotationAxis);
+        if(_OrbitCenter != nullptr){
+            glm::mat4 translation = glm::translate(glm::mat4(1.0f), glm::vec3(_OrbitRadius, 0.0f, 0.0f));
+            glm::mat4 rotation = glm::rotate(glm::mat4(1.0f), _OrbitSpeed*time, _OrbitAxis);
+            glm::mat4 tiltCorrection = glm::rotate(glm::mat4(1.0f), -_OrbitCenter->_RotationSpeed*time, _OrbitCenter->_RotationAxis);
+            _Model = _OrbitCenter->getModel() * tiltCorrection * rotation * translation * _Model;
+        }
+    }
+
+    const glm::mat4& getModel() const {
+        return _Model;
+    }
+};
+
+/**
+ * The bodies as a structure of arrays, sorted by depth
+*/
+struct Bodies{
+    std::vector<GLint> _Parents;
+    std::vector<GLfloat> _OrbitSpeeds, _OrbitRadii, _OrbitAxesX, _OrbitAxesY, _OrbitAxesZ;
+    std::vector<GLfloat> _Eccentricities, _MeanMotions, _MeanAnomalies;
+    std::vector<GLfloat> _PeriapsesX, _PeriapsesY, _PeriapsesZ, _SemiMinorAxesX, _SemiMinorAxesY, _SemiMinorAxesZ;
+    std::vector<GLfloat> _RotationSpeeds, _RotationAxesX, _RotationAxesY, _RotationAxesZ;
+    std::vector<GLfloat> _Sizes;
+    std::vector<GLdouble> _OriginsX, _OriginsY, _OriginsZ;
+    std::vector<glm::mat4> _Frames, _Models;
+    std::vector<glm::dvec3> _Positions;
+    std::vector<GLuint> _Levels;
+
+    TransformBatch getBatch(){
+        return TransformBatch{
+            _Parents.data(), _OrbitSpeeds.data(), _OrbitRadii.data(), _OrbitAxesX.data(), _OrbitAxesY.data(), _OrbitAxesZ.data(),
+            _Eccentricities.data(), _MeanMotions.data(), _MeanAnomalies.data(),
+            _PeriapsesX.data(), _PeriapsesY.data(), _PeriapsesZ.data(), _SemiMinorAxesX.data(), _SemiMinorAxesY.data(), _SemiMinorAxesZ.data(),
+            _RotationSpeeds.data(), _RotationAxesX.data(), _RotationAxesY.data(), _RotationAxesZ.data(),
+            _Sizes.data(), _OriginsX.data(), _OriginsY.data(), _OriginsZ.data(), _Frames.data(), _Models.data(),
+            _Positions.data()
+        };
+    }
+};
+
+GLfloat randomRange(GLfloat min, GLfloat max){
+    return min + (max - min) * (rand() / (GLfloat)RAND_MAX);
+}
+
+/**
+ * Create a system of 1% suns, 9% planets and 90% moons
+ * @param nbBodies The number of bodies
+ * @param legacy Filled with the planets, allocated one by one
+ * @param bodies Filled with the same bodies as arrays
+*/
+void createSystem(GLuint nbBodies, std::vector<std::unique_ptr<LegacyPlanet>>& legacy, Bodies& bodies){
+    const GLuint nbSuns = std::max(1u, nbBodies/100);
+    const GLuint nbPlanets = std::max(1u, nbBodies*9/100);
+    bodies._Levels = {0, nbSuns, std::min(nbBodies, nbSuns+nbPlanets), nbBodies};
+    legacy.clear();
+    legacy.reserve(nbBodies);
+    for(GLuint i=0; i<nbBodies; i++){
+        GLint parent = -1;
+        if(i >= bodies._Levels[2]) parent = bodies._Levels[1] + rand() % (bodies._Levels[2] - bodies._Levels[1]);
+        else if(i >= bodies._Levels[1]) parent = rand() % nbSuns;
+
+        glm::vec3 orbitAxis = glm::normalize(glm::vec3(randomRange(-0.1f, 0.1f), 1.0f, randomRange(-0.1f, 0.1f)));
+        glm::vec3 rotationAxis = glm::normalize(glm::vec3(randomRange(-0.5f, 0.5f), 1.0f, randomRange(-0.5f, 0.5f)));
+        LegacyPlanet* planet = new LegacyPlanet();
+        planet->_OrbitCenter = parent >= 0 ? legacy[parent].get() : nullptr;
+        planet->_OrbitSpeed = randomRange(0.1f, 2.0f);
+        planet->_OrbitRadius = randomRange(2.0f, 20.0f);
+        planet->_OrbitAxis = orbitAxis;
+        planet->_RotationSpeed = randomRange(0.1f, 5.0f);
+        planet->_RotationAxis = rotationAxis;
+        planet->_Size = randomRange(0.1f, 1.0f);
+        legacy.emplace_back(planet);
+
+        bodies._Parents.push_back(parent);
+        bodies._OrbitSpeeds.push_back(planet->_OrbitSpeed);
+        bodies._OrbitRadii.push_back(parent >= 0 ? planet->_OrbitRadius : 0.0f);
+        bodies._OrbitAxesX.push_back(orbitAxis.x);
+        bodies._OrbitAxesY.push_back(orbitAxis.y);
+        bodies._OrbitAxesZ.push_back(orbitAxis.z);
+        bodies._RotationSpeeds.push_back(planet->_RotationSpeed);
+        bodies._RotationAxesX.push_back(rotationAxis.x);
+        bodies._RotationAxesY.push_back(rotationAxis.y);
+        bodies._RotationAxesZ.push_back(rotationAxis.z);
+        bodies._Sizes.push_back(planet->_Size);
+        bodies._OriginsX.push_back(0.0);
+        bodies._OriginsY.push_back(0.0);
+        bodies._OriginsZ.push_back(0.0);
+    }
+    // circular orbits only, the Kepler solver still runs on every body
+    for(auto values : {&bodies._Eccentricities, &bodies._MeanMotions, &bodies._MeanAnomalies,
+                        &bodies._PeriapsesX, &bodies._PeriapsesY, &bodies._PeriapsesZ,
+                        &bodies._SemiMinorAxesX, &bodies._SemiMinorAxesY, &bodies._SemiMinorAxesZ}){
+        values->assign(nbBodies, 0.0f);
+    }
+    bodies._Frames.assign(nbBodies, glm::mat4(1.0f));
+    bodies._Models.assign(nbBodies, glm::mat4(1.0f));
+    bodies._Positions.assign(nbBodies, glm::dvec3(0.0));
+}
+
+/**
+ * Time a function over several frames
+ * @param update The function updating every body at a given time
+ * @return The average time per frame, in milliseconds
+*/
+template <typename Update>
+double timeFrames(const Update& update){
+    update(0.0f);
+    auto start = std::chrono::steady_clock::now();
+    for(int frame=0; frame<kNbFrames; frame++){
+        update(frame / 60.0f);
+    }
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / kNbFrames;
+}
+
+/**
+ * Get the largest error of the kernel's models against the former update, both at the same time
+ * @param legacy The planets, updated by the former update
+ * @param bodies The same bodies, updated by the kernel
+ * @return The largest error of a model's coefficient, relative to the model's largest coefficient
+*/
+double maxError(const std::vector<std::unique_ptr<LegacyPlanet>>& legacy, const Bodies& bodies){
+    double error = 0.0;
+    for(GLuint i=0; i<legacy.size(); i++){
+        const glm::mat4& expected = legacy[i]->getModel();
+        const glm::mat4& model = bodies._Models[i];
+        double difference = 0.0, scale = 0.0;
+        for(GLuint column=0; column<4; column++){
+            for(GLuint row=0; row<4; row++){
+                difference = std::max(difference, (double)std::abs(model[column][row] - expected[column][row]));
+                scale = std::max(scale, (double)std::abs(expected[column][row]));
+            }
+        }
+        error = std::max(error, difference / scale);
+    }
+    return error;
+}
+
+}
+
+int main(int argc, char** argv){
+    const GLuint sizes[] = {1000, 100000, 1000000};
+    const char* levelNames[] = {"scalar", "sse", "avx2"};
+    printf("best instruction set: %s\n\n", levelNames[detectSimdLevel()]);
+    printf("%10s %14s %14s %14s %14s %14s\n", "bodies", "legacy (ms)", "scalar (ms)", "sse (ms)", "avx2 (ms)", "max error");
+
+    for(GLuint nbBodies : sizes){
+        srand(42);
+        std::vector<std::unique_ptr<LegacyPlanet>> legacy;
+        Bodies bodies;
+        createSystem(nbBodies, legacy, bodies);
+
+        double legacyTime = timeFrames([&legacy](GLfloat time){
+            for(auto& planet : legacy) planet->update(time);
+        });
+        printf("%10u %14.3f", nbBodies, legacyTime);
+
+        TransformBatch batch = bodies.getBatch();
+        // the last timed frame of every configuration is at the same time
+        double error = 0.0;
+        for(int level=SIMD_SCALAR; level<=SIMD_AVX2; level++){
+            if(level > detectSimdLevel()){
+                printf(" %14s", "n/a");
+                continue;
+            }
+            double kernelTime = timeFrames([&](GLfloat time){
+                for(GLuint depth=0; depth+1<bodies._Levels.size(); depth++){
+                    buildTransforms(batch, time, bodies._Levels[depth], bodies._Levels[depth+1], (SimdLevel)level);
+                }
+            });
+            printf(" %14.3f", kernelTime);
+            error = std::max(error, maxError(legacy, bodies));
+        }
+        printf(" %14.3g\n", error);
+    }
+    return 0;
+}
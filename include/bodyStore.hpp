@@ -0,0 +1,383 @@
+#ifndef __BODY_STORE_HPP__
+#define __BODY_STORE_HPP__
+
+#include <cstdio>
+#include <glad/gl.h>
+#include <glm/glm.hpp>
+#include <memory>
+#include <vector>
+
+#include "errorHandler.hpp"
+#include "orbitalElements.hpp"
+#include "transformKernel.hpp"
+
+class BodyStore;
+using BodyStorePointer = std::shared_ptr<BodyStore>;
+
+/**
+ * A stable identifier of a body, valid until the body is removed
+*/
+using BodyHandle = GLuint;
+const static BodyHandle kInvalidBody = ~0u;
+
+using BodyFloats = std::vector<GLfloat>;
+using BodyDoubles = std::vector<GLdouble>;
+using BodyIndices = std::vector<GLint>;
+using BodyHandles = std::vector<BodyHandle>;
+using BodyMatrices = std::vector<glm::mat4>;
+using BodyPositions = std::vector<glm::dvec3>;
+
+/**
+ * The orbital state of every body, stored as one contiguous array per field
+ * and sorted parents first so that a single linear sweep updates the whole hierarchy
+*/
+class BodyStore{
+    private:
+        /**
+         * The static instance of the store
+        */
+        static BodyStorePointer _Instance;
+
+        /**
+         * The handle of each body
+        */
+        BodyHandles _Handles = {};
+
+        /**
+         * The index in the arrays of each handle, kInvalidBody for the free handles
+        */
+        BodyHandles _Slots = {};
+
+        /**
+         * The handles of the removed bodies, reused first
+        */
+        BodyHandles _FreeHandles = {};
+
+        /**
+         * The number of bodies orbiting around each handle, so that removing a body without satellites doesn't look for them
+        */
+        BodyHandles _NbSatellites = {};
+
+        /**
+         * The handle of the orbit center of each body, kInvalidBody if it doesn't orbit
+        */
+        BodyHandles _ParentHandles = {};
+
+        /**
+         * The index of the orbit center of each body, -1 if it doesn't orbit
+        */
+        BodyIndices _Parents = {};
+
+        /**
+         * The orbit speeds
+        */
+        BodyFloats _OrbitSpeeds = {};
+
+        /**
+         * The orbit radii
+        */
+        BodyFloats _OrbitRadii = {};
+
+        /**
+         * The orbit axes
+        */
+        BodyFloats _OrbitAxesX = {};
+        BodyFloats _OrbitAxesY = {};
+        BodyFloats _OrbitAxesZ = {};
+
+        /**
+         * The Kepler orbits' eccentricities, mean motions and mean anomalies at the time zero
+        */
+        BodyFloats _Eccentricities = {};
+        BodyFloats _MeanMotions = {};
+        BodyFloats _MeanAnomalies = {};
+
+        /**
+         * The Kepler orbits' periapsis directions scaled by the semi-major axes
+        */
+        BodyFloats _PeriapsesX = {};
+        BodyFloats _PeriapsesY = {};
+        BodyFloats _PeriapsesZ = {};
+
+        /**
+         * The Kepler orbits' semi-minor axis directions scaled by the semi-minor axes
+        */
+        BodyFloats _SemiMinorAxesX = {};
+        BodyFloats _SemiMinorAxesY = {};
+        BodyFloats _SemiMinorAxesZ = {};
+
+        /**
+         * The rotation speeds
+        */
+        BodyFloats _RotationSpeeds = {};
+
+        /**
+         * The rotation axes
+        */
+        BodyFloats _RotationAxesX = {};
+        BodyFloats _RotationAxesY = {};
+        BodyFloats _RotationAxesZ = {};
+
+        /**
+         * The sizes, relative to the orbit center's size
+        */
+        BodyFloats _Sizes = {};
+
+        /**
+         * The positions of the bodies without an orbit
+        */
+        BodyDoubles _OriginsX = {};
+        BodyDoubles _OriginsY = {};
+        BodyDoubles _OriginsZ = {};
+
+        /**
+         * The frames (the model matrices without the spin), in which the satellites orbit
+        */
+        BodyMatrices _Frames = {};
+
+        /**
+         * The model matrices
+        */
+        BodyMatrices _Models = {};
+
+        /**
+         * The frames at the rendered time, between the last two steps
+        */
+        BodyMatrices _RenderFrames = {};
+
+        /**
+         * The model matrices at the rendered time, relative to the render origin
+        */
+        BodyMatrices _RenderModels = {};
+
+        /**
+         * The positions in double precision, the float matrices only place the bodies near the origin
+        */
+        BodyPositions _Positions = {};
+
+        /**
+         * The positions of the previous step
+        */
+        BodyPositions _PreviousPositions = {};
+
+        /**
+         * The positions at the rendered time
+        */
+        BodyPositions _RenderPositions = {};
+
+        /**
+         * The positions of the bodies without an orbit at the rendered time, blended between the last two steps
+        */
+        BodyDoubles _RenderOriginsX = {};
+        BodyDoubles _RenderOriginsY = {};
+        BodyDoubles _RenderOriginsZ = {};
+
+        /**
+         * The simulation times of the last two steps
+        */
+        GLdouble _Time = 0.0;
+        GLdouble _PreviousTime = 0.0;
+
+        /**
+         * Tell if a step has been done, the times are set
+        */
+        GLboolean _HasStep = false;
+
+        /**
+         * The index of the first body of each depth, plus the number of bodies at the end
+        */
+        std::vector<GLuint> _Levels = {};
+
+        /**
+         * Tell if the bodies must be sorted again
+        */
+        GLboolean _IsOrderDirty = false;
+
+        /**
+         * Tell if the bodies have been sorted since the last step, the new ones have no previous step
+        */
+        GLboolean _IsOrderNew = false;
+
+    private:
+        /**
+         * An empty constructor
+        */
+        BodyStore(){}
+
+        /**
+         * Get the index of a body
+         * @param handle The body's handle
+         * @return The index of the body in the arrays
+        */
+        GLuint getSlot(BodyHandle handle) const {
+            if(handle >= _Slots.size() || _Slots[handle] == kInvalidBody){
+                fprintf(stderr, "Invalid body handle %d!\n", handle);
+                ErrorHandler::handle(ErrorCodes::OUT_OF_RANGE);
+            }
+            return _Slots[handle];
+        }
+
+        /**
+         * Set the Kepler orbit of a body
+         * @param index The body's index
+         * @param elements The orbital elements, a zero semi-major axis for no Kepler orbit
+        */
+        void setElements(GLuint index, const OrbitalElements& elements);
+
+        /**
+         * Change the orbit center of a body
+         * @param index The index of the body in the arrays
+         * @param orbitCenter The handle of the orbit center, kInvalidBody for none
+        */
+        void setParent(GLuint index, BodyHandle orbitCenter);
+
+        /**
+         * Sort the bodies by depth, keeping the order inside a depth
+        */
+        void sortByDepth();
+
+        /**
+         * Get the arrays read and written by the transform kernel
+         * @return The arrays of all the bodies
+        */
+        TransformBatch getBatch();
+
+    public:
+        /**
+         * Get the unique instance of the store
+         * @return The instance
+        */
+        static BodyStorePointer getInstance(){
+            if(!_Instance) _Instance = BodyStorePointer(new BodyStore());
+            return _Instance;
+        }
+
+        /**
+         * Add a body, not moving and not orbiting
+         * @return The new body's handle
+        */
+        BodyHandle create();
+
+        /**
+         * Remove a body, its satellites stop orbiting
+         * @param handle The body's handle
+        */
+        void remove(BodyHandle handle);
+
+        /**
+         * Make a body stand still at a position
+         * @param handle The body's handle
+         * @param size The body's size
+         * @param rotationSpeed The rotation's speed
+         * @param rotationAxis The rotation axis, normalized by the store
+         * @param origin The body's position
+        */
+        void setStill(BodyHandle handle, GLfloat size, GLfloat rotationSpeed, const glm::vec3& rotationAxis, const glm::dvec3& origin);
+
+        /**
+         * Move a body without an orbit, the next update places it there
+         * @param handle The body's handle
+         * @param origin The body's new position
+        */
+        void moveTo(BodyHandle handle, const glm::dvec3& origin){
+            const GLuint index = getSlot(handle);
+            _OriginsX[index] = origin.x;
+            _OriginsY[index] = origin.y;
+            _OriginsZ[index] = origin.z;
+        }
+
+        /**
+         * Make a body orbit around another one
+         * @param handle The body's handle
+         * @param size The body's size relative to its orbit center's size
+         * @param rotationSpeed The rotation's speed
+         * @param rotationAxis The rotation axis, normalized by the store
+         * @param orbitSpeed The orbit's rotation speed
+         * @param orbitAxis The orbit axis, normalized by the store
+         * @param orbitRadius The orbit's radius
+         * @param orbitCenter The handle of the orbit center
+        */
+        void setOrbit(BodyHandle handle, GLfloat size, GLfloat rotationSpeed, const glm::vec3& rotationAxis,
+                        GLfloat orbitSpeed, const glm::vec3& orbitAxis, GLfloat orbitRadius, BodyHandle orbitCenter);
+
+        /**
+         * Make a body follow a Kepler orbit around another one, its position is solved in closed form at any time
+         * @param handle The body's handle
+         * @param size The body's size relative to its orbit center's size
+         * @param rotationSpeed The rotation's speed
+         * @param rotationAxis The rotation axis, normalized by the store
+         * @param elements The orbital elements, in the orbit center's frame
+         * @param orbitCenter The handle of the orbit center
+        */
+        void setKepler(BodyHandle handle, GLfloat size, GLfloat rotationSpeed, const glm::vec3& rotationAxis,
+                        const OrbitalElements& elements, BodyHandle orbitCenter);
+
+        /**
+         * Update every body, orbit centers first, keeping the previous step for the interpolation
+         * @param time The simulation time
+        */
+        void update(GLdouble time);
+
+        /**
+         * Update a single body from its orbit center's current frame
+         * @param handle The body's handle
+         * @param time The simulation time
+        */
+        void update(BodyHandle handle, GLdouble time);
+
+        /**
+         * Solve the orbits at the rendered time, between the last two steps, translated so that the render origin is at zero.
+         * Only the positions of the bodies without an orbit are blended, the orbits and the spins stay exact whatever
+         * the steps' duration. The positions are subtracted in double precision, the matrices stay accurate near the origin
+         * @param alpha How far the rendered frame is from the previous step to the last one
+         * @param origin The render origin, usually the camera's position
+        */
+        void interpolate(GLfloat alpha, const glm::dvec3& origin);
+
+        /**
+         * Get the number of bodies
+         * @return The number of bodies
+        */
+        GLuint getNbBodies() const {
+            return _Handles.size();
+        }
+
+        /**
+         * Get the model matrix of a body
+         * @param handle The body's handle
+         * @return The model matrix
+        */
+        const glm::mat4& getModel(BodyHandle handle) const {
+            return _Models[getSlot(handle)];
+        }
+
+        /**
+         * Get the model matrix of a body interpolated for the rendering
+         * @param handle The body's handle
+         * @return The interpolated model matrix, relative to the render origin
+         * @see interpolate
+        */
+        const glm::mat4& getRenderModel(BodyHandle handle) const {
+            return _RenderModels[getSlot(handle)];
+        }
+
+        /**
+         * Get the frame of a body, its model matrix without its spin
+         * @param handle The body's handle
+         * @return The frame
+        */
+        const glm::mat4& getFrame(BodyHandle handle) const {
+            return _Frames[getSlot(handle)];
+        }
+
+        /**
+         * Get the position of a body
+         * @param handle The body's handle
+         * @return The position, in world space
+        */
+        const glm::dvec3& getPosition(BodyHandle handle) const {
+            return _Positions[getSlot(handle)];
+        }
+};
+
+#endif
@@ -5,6 +5,8 @@
 #include <glm/glm.hpp>
 #include <glm/ext.hpp>
 #include <glad/gl.h>
+#include <cmath>
+#include <limits>
 #include <memory>
 #include <ostream>
 
@@ -19,20 +21,25 @@ enum CameraMovement{
     DOWN,
 };
 
+/**
+ * The depth of an orthographic projection without far plane, it can't be infinite
+*/
+const static GLfloat kOrthoMaxDepth = 1.0e6f;
+
 /**
  * A class representing the camera
 */
 class Camera{
     private:
         /**
-         * The center of the camera
+         * The center of the camera, in double precision like the bodies' positions
         */
-        glm::vec3 _Center = glm::vec3(0, 0, 3.0);
+        glm::dvec3 _Center = glm::dvec3(0, 0, 3.0);
 
         /**
          * The look at
         */
-        glm::vec3 _At = glm::vec3(0, 0, 0);
+        glm::dvec3 _At = glm::dvec3(0, 0, 0);
 
         /**
          * The up vector
@@ -55,15 +62,21 @@ class Camera{
         GLfloat _Near = 0.1f;
 
         /**
-         * The distance after which the geometry is excluded from the rasterization process
+         * The distance after which the geometry is excluded from the rasterization process.
+         * Infinite by default, the bodies can be anywhere around the camera
         */
-        GLfloat _Far = 100.f;
+        GLfloat _Far = std::numeric_limits<GLfloat>::infinity();
 
         /**
          * The camera's speed
         */
         GLfloat _Speed = 10.f;
 
+        /**
+         * The height of the viewport, in pixels
+        */
+        GLfloat _ViewportHeight = 600.f;
+
 
     public:
         /**
@@ -82,7 +95,7 @@ class Camera{
          * @param near The near plane
          * @param far The far plane
         */
-        Camera(glm::vec3 center, glm::vec3 at, glm::vec3 up, GLfloat fov, GLfloat ratio, GLfloat near, GLfloat far){
+        Camera(glm::dvec3 center, glm::dvec3 at, glm::vec3 up, GLfloat fov, GLfloat ratio, GLfloat near, GLfloat far){
             _Center = center;
             _At = at;
             _Up = up;
@@ -96,7 +109,7 @@ class Camera{
          * Get the position of the camera
          * @return The position
         */
-        const glm::vec3 getPosition() const {
+        const glm::dvec3 getPosition() const {
             return _Center;
         }
 
@@ -104,7 +117,7 @@ class Camera{
          * Move the camera to a given position
          * @param newPos The new camera position
         */
-        void moveTo(const glm::vec3& newPos){
+        void moveTo(const glm::dvec3& newPos){
             _Center = newPos;
         }
 
@@ -112,7 +125,7 @@ class Camera{
          * Set the camera's targer
          * @param target The new camera's target
         */
-        void setTarget(const glm::vec3& target){
+        void setTarget(const glm::dvec3& target){
             _At = target;
         }
 
@@ -129,11 +142,40 @@ class Camera{
         }
 
         /**
-         * Compute the view matrix
+         * Set the size of the viewport, also updating the aspect ratio
+         * @param width The viewport's width, in pixels
+         * @param height The viewport's height, in pixels
+        */
+        void setViewport(GLuint width, GLuint height){
+            if(width == 0 || height == 0){
+                fprintf(stderr, "The viewport must not be empty!\n");
+                return;
+            }
+            _ViewportHeight = height;
+            setRatio(((GLfloat)width)/height);
+        }
+
+        /**
+         * Compute the radius on the screen of a sphere seen through the perspective projection
+         * @param center The sphere's center, relative to the camera
+         * @param radius The sphere's radius
+         * @return The projected radius, in pixels
+        */
+        GLfloat getProjectedRadius(const glm::vec3& center, GLfloat radius) const {
+            GLfloat distance = glm::length(center);
+            // the camera is inside the sphere, it covers the whole screen
+            if(distance <= radius) return _ViewportHeight;
+            GLfloat halfHeight = glm::tan(glm::radians(_Fov) / 2.0f);
+            return radius / (distance * halfHeight) * _ViewportHeight / 2.0f;
+        }
+
+        /**
+         * Compute the view matrix, with the camera at the origin: the scene is rendered relative to the camera
          * @return The view matrix
+         * @see BodyStore::interpolate
         */
         glm::mat4 getViewMatrix() const {
-            return glm::lookAt(_Center, _At, _Up);
+            return glm::lookAt(glm::vec3(0.0f), glm::vec3(_At - _Center), _Up);
         }
 
         /**
@@ -148,15 +190,17 @@ class Camera{
                 case ORTHO:{
                     float halfHeight = _Near * glm::tan(glm::radians(_Fov) / 2.0f);
                     float halfWidth = halfHeight * _Ratio;
-                    GLfloat up = _Center.y-halfHeight;
-                    GLfloat down = _Center.y+halfHeight;
-                    GLfloat left = _Center.x-halfWidth;
-                    GLfloat right = _Center.x+halfWidth;
-                    res = glm::ortho(left, right, down, up, _Near, _Far);
+                    GLfloat up = (GLfloat)_Center.y-halfHeight;
+                    GLfloat down = (GLfloat)_Center.y+halfHeight;
+                    GLfloat left = (GLfloat)_Center.x-halfWidth;
+                    GLfloat right = (GLfloat)_Center.x+halfWidth;
+                    res = glm::ortho(left, right, down, up, _Near, std::isinf(_Far) ? kOrthoMaxDepth : _Far);
                     break;
                 }
                 case PERSP:{
-                    res = glm::perspective(glm::radians(_Fov), _Ratio, _Near, _Far);
+                    // without far plane the depth only loses precision far away, where the bodies are a few pixels wide
+                    res = std::isinf(_Far) ? glm::infinitePerspective(glm::radians(_Fov), _Ratio, _Near)
+                                           : glm::perspective(glm::radians(_Fov), _Ratio, _Near, _Far);
                     break;
                 }
             }
@@ -206,25 +250,26 @@ class Camera{
         void move(CameraMovement direction, GLfloat dt){
             float velocity = _Speed * dt;
 
-            glm::vec3 front = glm::normalize(_At - _Center);
-            glm::vec3 right = glm::normalize(glm::cross(front, _Up));
+            glm::vec3 front = glm::normalize(glm::vec3(_At - _Center));
+            glm::dvec3 right = glm::dvec3(glm::normalize(glm::cross(front, _Up)));
+            glm::dvec3 up = glm::dvec3(_Up);
 
             switch(direction){
                 case UP:
-                    _Center += _Up * velocity;
-                    _At += _Up * velocity;
+                    _Center += up * (GLdouble)velocity;
+                    _At += up * (GLdouble)velocity;
                     break;
                 case DOWN:
-                    _Center -= _Up * velocity;
-                    _At -= _Up * velocity;
+                    _Center -= up * (GLdouble)velocity;
+                    _At -= up * (GLdouble)velocity;
                     break;
                 case RIGHT:
-                    _Center += right * velocity;
-                    _At += right * velocity;
+                    _Center += right * (GLdouble)velocity;
+                    _At += right * (GLdouble)velocity;
                     break;
                 case LEFT:
-                    _Center -= right * velocity;
-                    _At -= right * velocity;
+                    _Center -= right * (GLdouble)velocity;
+                    _At -= right * (GLdouble)velocity;
                     break;
             }
         }
@@ -0,0 +1,197 @@
+#ifndef __CATALOG_LOADER_HPP__
+#define __CATALOG_LOADER_HPP__
+
+#include <atomic>
+#include <cstdio>
+#include <glad/gl.h>
+#include <glm/glm.hpp>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "material.hpp"
+#include "shaders.hpp"
+#include "spscQueue.hpp"
+
+class Scene;
+
+class CatalogLoader;
+using CatalogLoaderPointer = std::shared_ptr<CatalogLoader>;
+
+/**
+ * The number of bytes read from the catalog at once
+*/
+const static GLuint kCatalogChunkSize = 1 << 16;
+
+/**
+ * The number of bodies handed to the main thread at once
+*/
+const static GLuint kCatalogBatchSize = 256;
+
+/**
+ * The number of batches waiting for the main thread, the reading pauses beyond
+*/
+const static std::size_t kCatalogQueueSize = 64;
+
+/**
+ * A body read from a catalog, ready to be added to the scene
+*/
+struct CatalogBody{
+    /**
+     * The position, in world space
+    */
+    glm::dvec3 _Position;
+
+    /**
+     * The size
+    */
+    GLfloat _Size;
+
+    /**
+     * The color
+    */
+    glm::vec4 _Color;
+};
+
+using CatalogBatch = std::vector<CatalogBody>;
+using CatalogQueue = SpscQueue<CatalogBatch, kCatalogQueueSize>;
+
+/**
+ * A loader of the star and asteroid catalogs, text files of one body per line:
+ * @code
+ * # x y z size [r g b]
+ * 1520.5 -32.25 804.0 0.2
+ * -77.0 12.5 3050.75 0.5 1.0 0.8 0.6
+ * @endcode
+ * A worker thread reads the file by chunks and converts the lines into bodies, the batches are handed to the
+ * main thread through a lock-free queue. The scene adds them within a time budget at each frame, so the bodies
+ * appear progressively while the window stays responsive
+ * @see Scene::setCatalog
+*/
+class CatalogLoader{
+    private:
+        /**
+         * The file being read, owned by the worker until it is done
+        */
+        FILE* _File = nullptr;
+
+        /**
+         * The file's path, for the messages
+        */
+        std::string _FileName = "";
+
+        /**
+         * The material and the shader of every body
+        */
+        MaterialPointer _Material = nullptr;
+        ShadersPointer _Shader = nullptr;
+
+        /**
+         * The color of the bodies without one
+        */
+        glm::vec4 _Color = glm::vec4(1.0f);
+
+        /**
+         * The batches filled by the worker, for the main thread
+        */
+        CatalogQueue _Filled;
+
+        /**
+         * The batches added by the main thread, given back to the worker to be filled again
+        */
+        CatalogQueue _Empty;
+
+        /**
+         * The number of lines that aren't bodies, written by the worker
+        */
+        std::atomic<GLuint> _NbMalformed{0};
+
+        /**
+         * Tell if the worker has pushed its last batch
+        */
+        std::atomic<bool> _IsRead{false};
+
+        /**
+         * Tell the worker to stop
+        */
+        std::atomic<bool> _IsStopping{false};
+
+        /**
+         * Tell if every body has been added, on the main thread
+        */
+        GLboolean _IsDone = false;
+
+        /**
+         * The worker thread
+        */
+        std::thread _Worker;
+
+    private:
+        /**
+         * A loader of an opened file
+         * @param file The file, closed by the loader
+         * @param fileName The file's path
+         * @param material The material of every body
+         * @param shader The shader of every body
+         * @param color The color of the bodies without one
+        */
+        CatalogLoader(FILE* file, const std::string& fileName, const MaterialPointer& material,
+                        const ShadersPointer& shader, const glm::vec4& color)
+            : _File(file), _FileName(fileName), _Material(material), _Shader(shader), _Color(color){}
+
+        /**
+         * The loop of the worker thread, reading the whole file
+        */
+        void read();
+
+        /**
+         * Convert a line into a body
+         * @param begin The line's first character
+         * @param end The character after the line's last one
+         * @param batch The batch where to add the body
+        */
+        void parseLine(const char* begin, const char* end, CatalogBatch& batch);
+
+        /**
+         * Hand a batch to the main thread, waiting while the queue is full
+         * @param batch The batch, replaced by an empty one
+         * @return False if the loader is stopping
+        */
+        bool send(CatalogBatch& batch);
+
+    public:
+        /**
+         * Stop and join the worker
+        */
+        ~CatalogLoader();
+
+        /**
+         * Open a catalog and start reading it in the background
+         * @param fileName The file's path
+         * @param material The material of every body
+         * @param shader The shader of every body
+         * @param color The color of the bodies without one
+         * @return The loader, nullptr if the file can't be read
+        */
+        static CatalogLoaderPointer start(const std::string& fileName, const MaterialPointer& material,
+                                            const ShadersPointer& shader, const glm::vec4& color = glm::vec4(1.0f));
+
+        /**
+         * Add the bodies read so far to a scene, from the main thread
+         * @param scene The scene
+         * @param budget The real time allowed, in seconds, at least one batch is added
+         * @return False once every body has been added
+        */
+        GLboolean addBodies(Scene& scene, GLdouble budget);
+
+        /**
+         * Tell if every body has been added
+         * @return True if the loader can be released
+        */
+        GLboolean isDone() const {
+            return _IsDone;
+        }
+};
+
+#endif
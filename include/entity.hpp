@@ -6,10 +6,11 @@
 #include <glad/gl.h>
 #include <memory>
 
+#include "instancedRenderer.hpp"
 #include "mesh.hpp"
 #include "material.hpp"
 #include "shaders.hpp"
-#include "stb_image.h"
+#include "textureManager.hpp"
 
 class Scene;
 using ScenePointer = std::shared_ptr<Scene>;
@@ -17,22 +18,10 @@ using ScenePointer = std::shared_ptr<Scene>;
 class Entity;
 using EntityPointer = std::shared_ptr<Entity>;
 
-enum Filtering{
-    LINEAR,
-    NEAREST,
-};
-
-enum Wrapping{
-    REPEAT,
-    MIRRORED_REPEAT,
-    CLAMP_TO_EDGE,
-    CLAMP_TO_BORDER,
-};
-
 /**
- * A class representing an entity in the scene
+ * A class representing an entity in the scene, always owned by shared pointers
 */
-class Entity {
+class Entity : public std::enable_shared_from_this<Entity> {
 
     protected:
         /**
@@ -56,14 +45,24 @@ class Entity {
         glm::mat4 _Model = glm::mat4(1.0f);
 
         /**
-         * The texture Id
+         * The entity's model matrix for the rendering, relative to the render origin
         */
-        GLuint _TexId = 0;
+        glm::mat4 _RenderModel = glm::mat4(1.0f);
 
         /**
-         * A boolean to tell if the entity has a texture
+         * The texture, shared with the entities using the same image
         */
-        GLboolean _HasTex = false;
+        TexturePointer _Texture = nullptr;
+
+        /**
+         * The sampler of the texture, shared with the entities sampling the same way
+        */
+        SamplerPointer _Sampler = nullptr;
+
+        /**
+         * The entity's color, multiplied with its vertex colors
+        */
+        glm::vec4 _Color = glm::vec4(1.0f);
 
 
     public:
@@ -82,7 +81,7 @@ class Entity {
         /**
          * Initiate the entity
         */
-        virtual void init() const {
+        virtual void init() {
             _Mesh->initGpuGeometry();
             _Shader->setInt("fAlbedoTex", 0);
         }
@@ -103,6 +102,15 @@ class Entity {
             return _Model;
         }
 
+        /**
+         * Get the model matrix of the entity for the rendering
+         * @return A copy of the model matrix, relative to the render origin
+         * @see interpolate
+        */
+        const glm::mat4 getRenderModel() const {
+            return _RenderModel;
+        }
+
         /**
          * Get the material
          * @return A pointer to the material
@@ -111,24 +119,123 @@ class Entity {
             return _Material;
         }
 
+        /**
+         * Set the entity's color
+         * @param color The color multiplied with the vertex colors
+        */
+        void setColor(const glm::vec4& color){
+            _Color = color;
+        }
+
+        /**
+         * Get the texture Id
+         * @return The texture Id (0 if the entity has no texture or if it is still loading)
+        */
+        GLuint getTexture() const {
+            return _Texture ? _Texture->getId() : 0;
+        }
+
+        /**
+         * Get the sampler Id
+         * @return The sampler Id (0 if the entity has no texture)
+        */
+        GLuint getSampler() const {
+            return _Sampler ? _Sampler->getId() : 0;
+        }
+
+        /**
+         * Get the per instance data of the entity
+         * @return The instance data
+        */
+        InstanceData getInstanceData() const {
+            InstanceData instance;
+            instance._Model = _RenderModel;
+            instance._Color = _Color;
+            instance._Material = _Material->getParameters();
+            instance._UseTex = _Texture && _Texture->isReady() ? 1.0f : 0.0f;
+            return instance;
+        }
+
+        /**
+         * Get the mesh shared with other entities for instanced rendering
+         * @return The shared mesh, or nullptr if the entity must be rendered on its own
+        */
+        virtual MeshPointer getInstancedMesh() const {
+            return nullptr;
+        }
+
+        /**
+         * Blend the entity's last two simulation steps before rendering, relative to the render origin
+         * @param alpha How far the rendered frame is from the previous step to the last one
+         * @param origin The render origin, usually the camera's position
+        */
+        virtual void interpolate(GLfloat alpha, const glm::dvec3& origin) {
+            _RenderModel = _Model;
+            _RenderModel[3] -= glm::vec4(glm::vec3(origin), 0.0f);
+        }
+
+        /**
+         * Get the sphere bounding the entity, relative to the render origin
+         * @return The center (xyz) and radius (w) of the sphere, the radius is negative if the entity is unbounded
+        */
+        virtual glm::vec4 getBoundingSphere() const {
+            return glm::vec4(glm::vec3(_RenderModel[3]), -1.0f);
+        }
+
+        /**
+         * Select the level of detail of the entity's mesh
+         * @param projectedRadius The radius of the bounding sphere on the screen, in pixels
+        */
+        virtual void selectLod(GLfloat projectedRadius) {}
+
         /**
          * Update the entity
-         * @param dt The delta time
+         * @param time The simulation time
         */
-        virtual void update(GLfloat dt) = 0;
+        virtual void update(GLdouble time) = 0;
+
+        /**
+         * Get the entity whose transform this entity's transform depends on
+         * @return The parent, or nullptr if the entity is a root
+        */
+        virtual const Entity* getParent() const {
+            return nullptr;
+        }
+
+        /**
+         * Tell if the entity's transform is computed by the body store, the scene graph then skips it
+         * @return True if the entity is a body of the store
+         * @see BodyStore
+        */
+        virtual GLboolean isInStore() const {
+            return false;
+        }
+
+        /**
+         * Update the entity's model matrix from its parent's frame,
+         * called concurrently for the entities of the same depth
+         * @param time The simulation time
+         * @param parentFrame The frame given by the parent to its children (identity for the roots)
+         * @return The frame given to the entity's children
+         * @see SceneGraph
+        */
+        virtual glm::mat4 updateTransform(GLdouble time, const glm::mat4& parentFrame) {
+            update(time);
+            return _Model;
+        }
 
         /**
          * Render the entity
-         * @cond The shader must have a "modelMat" uniform 4x4 matrix
+         * @cond The shader must read the per instance attributes
+         * @see InstanceAttribute
         */
         virtual void render() const {
-            // set the model matrix in the gpu
+            // set the instance attributes as constants
             _Shader->use();
-            _Shader->setMat4f("modelMat", _Model);
-            _Shader->setBool("useTex", _HasTex);
-            _Material->setShaderValues(_Shader);
+            InstancedRenderer::setConstantInstance(getInstanceData());
             glActiveTexture(GL_TEXTURE0);
-            glBindTexture(GL_TEXTURE_2D, _TexId);
+            glBindTexture(GL_TEXTURE_2D, getTexture());
+            glBindSampler(0, getSampler());
             _Mesh->render();
         }
 
@@ -141,30 +248,18 @@ class Entity {
         }
 
         /**
-         * Load a texture
+         * Load a texture in the background, the entity is drawn without it until it is ready
          * @param fileName The texture file
          * @param minFilter The minifying filter
          * @param magFilter The magnifying filter
          * @param wrapS The wrapping property of the texture for the S axis
          * @param wrapT The wrapping property of the texture for the T axis
+         * @see TextureManager
         */
         void loadTexture(const std::string& fileName, Filtering minFilter = LINEAR, Filtering magFilter = LINEAR, Wrapping wrapS = REPEAT, Wrapping wrapT = REPEAT){
-            // Loading the image in CPU memory using stb_image
-            int width, height, numComponents;
-            unsigned char *data = stbi_load(fileName.c_str(), &width, &height, &numComponents, 0);
-            glGenTextures(1, &_TexId); // generate an OpenGL texture container
-            glBindTexture(GL_TEXTURE_2D, _TexId); // activate the texture
-            // Setup the texture filtering option and repeat mode; check www.opengl.org for details.
-            setMagFilter(magFilter);
-            setMinFilter(minFilter);
-            setWrapS(wrapS);
-            setWrapT(wrapT);
-            // Fill the GPU texture with the data stored in the CPU image
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-            // Free useless CPU memory
-            stbi_image_free(data);
-            glBindTexture(GL_TEXTURE_2D, 0); // unbind the texture
-            _HasTex = true;
+            TextureManagerPointer textures = TextureManager::getInstance();
+            _Texture = textures->load(fileName);
+            _Sampler = textures->getSampler(minFilter, magFilter, wrapS, wrapT);
         }
 
         /**
@@ -172,79 +267,6 @@ class Entity {
          * @param scene The scene where to add the entity
         */
         virtual void addToScene(const ScenePointer& scene);
-
-    private:
-        /**
-         * Set the minifyer filter
-         * @param filter The filter to use
-        */
-        void setMinFilter(Filtering filter) const {
-            switch (filter) {
-                case LINEAR:
-                    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-                    break;
-                case NEAREST:
-                    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-                    break;
-            }
-        }
-
-        /**
-         * Set the magnifyer filter
-         * @param filter The filter to use
-        */
-        void setMagFilter(Filtering filter) const {
-            switch (filter) {
-                case LINEAR:
-                    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-                    break;
-                case NEAREST:
-                    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-                    break;
-            }
-        }
-
-        /**
-         * Set the texture wrapping for the S axis
-         * @param wrap The wrapping to use
-        */
-        void setWrapS(Wrapping wrap) const {
-            switch(wrap){
-                case REPEAT:
-                    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-                    break;
-                case MIRRORED_REPEAT:
-                    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_MIRRORED_REPEAT);
-                    break;
-                case CLAMP_TO_EDGE:
-                    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-                    break;
-                case CLAMP_TO_BORDER:
-                    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
-                    break;
-            }
-        }
-
-        /**
-         * Set the texture wrapping for the T axis
-         * @param wrap The wrapping to use
-        */
-        void setWrapT(Wrapping wrap) const {
-            switch(wrap){
-                case REPEAT:
-                    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-                    break;
-                case MIRRORED_REPEAT:
-                    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_MIRRORED_REPEAT);
-                    break;
-                case CLAMP_TO_EDGE:
-                    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-                    break;
-                case CLAMP_TO_BORDER:
-                    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
-                    break;
-            }
-        }
 };
 
 #endif
\ No newline at end of file
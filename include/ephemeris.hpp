@@ -0,0 +1,229 @@
+#ifndef __EPHEMERIS_HPP__
+#define __EPHEMERIS_HPP__
+
+#include <cstddef>
+#include <cstdint>
+#include <glad/gl.h>
+#include <glm/glm.hpp>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "bodyStore.hpp"
+
+class Ephemeris;
+using EphemerisPointer = std::shared_ptr<Ephemeris>;
+
+/**
+ * The first bytes of an ephemeris file
+*/
+const static char kEphemerisMagic[4] = {'E', 'P', 'H', 'M'};
+
+/**
+ * The version of the ephemeris format read
+*/
+const static std::uint32_t kEphemerisVersion = 1;
+
+/**
+ * The largest number of Chebyshev coefficients of a segment
+*/
+const static std::uint32_t kMaxChebyshevCoefficients = 32;
+
+/**
+ * The header of an ephemeris file, followed by one record per body
+*/
+struct EphemerisHeader{
+    /**
+     * kEphemerisMagic
+    */
+    char _Magic[4];
+
+    /**
+     * kEphemerisVersion
+    */
+    std::uint32_t _Version;
+
+    /**
+     * The number of records following the header
+    */
+    std::uint32_t _NbRecords;
+
+    /**
+     * Unused, keeps the records aligned
+    */
+    std::uint32_t _Padding;
+};
+
+/**
+ * The trajectory of a body, cut in segments of equal durations each fitted by Chebyshev polynomials.
+ * A segment is 3 * _NbCoefficients doubles, the coefficients of x then y then z, lowest degree first.
+ * The segment k covers [_Start + k * _SegmentDuration, _Start + (k + 1) * _SegmentDuration)
+ * and starts at the byte _Offset + k * _Stride of the file: a stride of the segment's size stores
+ * the body's segments together, a stride of all the bodies' segments stores the file by time window
+*/
+struct EphemerisRecord{
+    /**
+     * The time at which the first segment starts
+    */
+    GLdouble _Start;
+
+    /**
+     * The duration of a segment
+    */
+    GLdouble _SegmentDuration;
+
+    /**
+     * The byte of the file where the first segment starts, a multiple of 8
+    */
+    std::uint64_t _Offset;
+
+    /**
+     * The number of bytes from a segment to the next one, a multiple of 8
+    */
+    std::uint64_t _Stride;
+
+    /**
+     * The number of segments
+    */
+    std::uint32_t _NbSegments;
+
+    /**
+     * The number of Chebyshev coefficients of each coordinate, the polynomials' degree plus one
+    */
+    std::uint32_t _NbCoefficients;
+};
+
+static_assert(sizeof(EphemerisHeader) == 16, "The ephemeris header must match the file layout");
+static_assert(sizeof(EphemerisRecord) == 40, "The ephemeris records must match the file layout");
+
+/**
+ * Precomputed trajectories read from a memory-mapped file.
+ * Nothing is parsed at load: the positions are evaluated from the segment of the current time,
+ * so only the pages of the current time window are ever read from the disk
+*/
+class Ephemeris{
+    private:
+        /**
+         * The mapped file
+        */
+        const std::uint8_t* _Data = nullptr;
+
+        /**
+         * The size of the file, in bytes
+        */
+        std::size_t _Size = 0;
+
+#ifdef _WIN32
+        /**
+         * The file and mapping handles
+        */
+        void* _File = nullptr;
+        void* _Mapping = nullptr;
+#endif
+
+        /**
+         * The records, in the mapped file
+        */
+        const EphemerisRecord* _Records = nullptr;
+
+        /**
+         * The number of records
+        */
+        GLuint _NbRecords = 0;
+
+        /**
+         * The bodies of the store moved along the trajectories
+        */
+        BodyHandles _Bodies = {};
+
+        /**
+         * The record of each bound body
+        */
+        std::vector<GLuint> _BodyRecords = {};
+
+        /**
+         * The binding of each body
+        */
+        std::unordered_map<BodyHandle, GLuint> _Bindings = {};
+
+    private:
+        /**
+         * An empty constructor
+        */
+        Ephemeris(){}
+
+        /**
+         * Map a file in memory
+         * @param fileName The file's path
+         * @return True if the file has been mapped
+        */
+        GLboolean map(const std::string& fileName);
+
+        /**
+         * Check the header and the records, without reading the segments
+         * @param fileName The file's path, for the messages
+         * @return True if every segment lies in the file
+        */
+        GLboolean validate(const std::string& fileName);
+
+    public:
+        Ephemeris(const Ephemeris&) = delete;
+        Ephemeris& operator=(const Ephemeris&) = delete;
+
+        /**
+         * Unmap the file
+        */
+        ~Ephemeris();
+
+        /**
+         * Map an ephemeris file
+         * @param fileName The file's path
+         * @return The ephemeris, nullptr if the file can't be read or is malformed
+        */
+        static EphemerisPointer load(const std::string& fileName);
+
+        /**
+         * Get the number of trajectories
+         * @return The number of records
+        */
+        GLuint getNbRecords() const {
+            return _NbRecords;
+        }
+
+        /**
+         * Get the time span of a trajectory
+         * @param record The record's index
+         * @return The start (x) and end (y) times
+        */
+        glm::dvec2 getTimeSpan(GLuint record) const;
+
+        /**
+         * Evaluate the position of a body, held at the ends of its trajectory outside of its time span
+         * @param record The record's index
+         * @param time The simulation time
+         * @return The position, in world space
+        */
+        glm::dvec3 getPosition(GLuint record, GLdouble time) const;
+
+        /**
+         * Move a body of the store along a trajectory at each update
+         * @param record The record's index
+         * @param body The body's handle
+        */
+        void bind(GLuint record, BodyHandle body);
+
+        /**
+         * Stop moving a body
+         * @param body The body's handle
+        */
+        void unbind(BodyHandle body);
+
+        /**
+         * Move the bound bodies to their positions, in parallel
+         * @param time The simulation time
+        */
+        void moveBodies(GLdouble time) const;
+};
+
+#endif
@@ -0,0 +1,65 @@
+#ifndef __FRUSTUM_HPP__
+#define __FRUSTUM_HPP__
+
+#include <glad/gl.h>
+#include <glm/glm.hpp>
+#include <vector>
+
+using BoundingSpheres = std::vector<glm::vec4>;
+using Visibilities = std::vector<GLubyte>;
+
+/**
+ * @enum The planes of the view frustum
+*/
+enum FrustumPlane{
+    LEFT_PLANE,
+    RIGHT_PLANE,
+    BOTTOM_PLANE,
+    TOP_PLANE,
+    NEAR_PLANE,
+    FAR_PLANE,
+    NB_FRUSTUM_PLANES,
+};
+
+/**
+ * A class representing the volume seen by a camera, to discard what is outside of it
+*/
+class Frustum{
+    private:
+        /**
+         * The planes (normal in xyz, distance in w), with the normals pointing inside
+        */
+        glm::vec4 _Planes[NB_FRUSTUM_PLANES];
+
+    public:
+        /**
+         * Extract the planes of a frustum from the camera matrices
+         * @param viewProj The projection matrix multiplied by the view matrix
+        */
+        Frustum(const glm::mat4& viewProj);
+
+        /**
+         * Get a plane
+         * @param plane The plane to get
+         * @return The normalized plane equation
+        */
+        const glm::vec4& getPlane(FrustumPlane plane) const {
+            return _Planes[plane];
+        }
+
+        /**
+         * Test if a sphere is at least partly inside the frustum
+         * @param sphere The center (xyz) and radius (w) of the sphere, a negative radius is always visible
+         * @return True if the sphere may be visible
+        */
+        GLboolean isVisible(const glm::vec4& sphere) const;
+
+        /**
+         * Test a whole array of spheres, four at a time when SSE is available
+         * @param spheres The center (xyz) and radius (w) of each sphere, a negative radius is always visible
+         * @param visible Filled with 1 for each sphere that may be visible and 0 otherwise
+        */
+        void cull(const BoundingSpheres& spheres, Visibilities& visible) const;
+};
+
+#endif
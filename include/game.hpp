@@ -4,14 +4,31 @@
 #include <glad/gl.h>
 #include <GLFW/glfw3.h>
 
+#include <cstdio>
 #include <memory>
 #include <iostream>
 
 #include "errorHandler.hpp"
 #include "scene.hpp"
+#include "simulationClock.hpp"
 
 class Game;
 
+/**
+ * The default real time of a frame given to the simulation, in seconds
+*/
+const static GLdouble kDefaultSimulationBudget = 0.008;
+
+/**
+ * The default real time of a frame given to adding the bodies read in the background, in seconds
+*/
+const static GLdouble kDefaultIngestionBudget = 0.002;
+
+/**
+ * The factor applied to the time scale by the time warp keys
+*/
+const static GLdouble kTimeWarpFactor = 10.0;
+
 using GameWindow = std::unique_ptr<GLFWwindow, decltype(&glfwDestroyWindow)>;
 using GamePointer = std::shared_ptr<Game>;
 
@@ -49,7 +66,22 @@ class Game{
         /**
          * The last time frame
         */
-        GLfloat _LastTimeFrame = 0.0f;
+        GLdouble _LastTimeFrame = 0.0;
+
+        /**
+         * The clock running the simulation by fixed steps
+        */
+        SimulationClock _Clock;
+
+        /**
+         * The real time of a frame given to the simulation, in seconds
+        */
+        GLdouble _SimulationBudget = kDefaultSimulationBudget;
+
+        /**
+         * The real time of a frame given to adding the bodies read in the background, in seconds
+        */
+        GLdouble _IngestionBudget = kDefaultIngestionBudget;
 
         /**
          * Boolean to check the press keys
@@ -198,6 +230,38 @@ class Game{
             if(scene) _Scene = scene;
         }
 
+        /**
+         * Set the number of simulation steps per second, independent from the frame rate
+         * @param rate The number of steps per second
+        */
+        void setSimulationRate(GLdouble rate){
+            _Clock.setRate(rate);
+        }
+
+        /**
+         * Set the number of simulated seconds per real second
+         * @param timeScale The time scale, between 1 and kMaxTimeScale
+        */
+        void setTimeScale(GLdouble timeScale){
+            _Clock.setTimeScale(timeScale);
+        }
+
+        /**
+         * Set the real time of a frame given to the simulation, the integrated bodies lose accuracy beyond it
+         * @param budget The time, in seconds
+        */
+        void setSimulationBudget(GLdouble budget){
+            _SimulationBudget = budget;
+        }
+
+        /**
+         * Set the real time of a frame given to adding the bodies read in the background, the rest waits for the next frames
+         * @param budget The time, in seconds
+        */
+        void setIngestionBudget(GLdouble budget){
+            _IngestionBudget = budget;
+        }
+
         /**
          * The main loop
         */
@@ -207,7 +271,7 @@ class Game{
          * Update the delta time
         */
         void update(){
-            GLfloat curTime = glfwGetTime();
+            GLdouble curTime = glfwGetTime();
             _Dt = curTime - _LastTimeFrame;
             _LastTimeFrame = curTime;
             // update the camera
@@ -294,6 +358,17 @@ class Game{
             }
         }
 
+        /**
+         * The command to speed up or slow down the simulated time
+         * @param factor The factor applied to the time scale
+        */
+        void timeWarpCommand(GLdouble factor){
+            GLdouble timeScale = _Clock.getTimeScale() * factor;
+            timeScale = timeScale < 1.0 ? 1.0 : (timeScale > kMaxTimeScale ? kMaxTimeScale : timeScale);
+            _Clock.setTimeScale(timeScale);
+            fprintf(stderr, "Time scale: %gx\n", timeScale);
+        }
+
         /**
          * Update the camera
         */
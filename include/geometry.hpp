@@ -0,0 +1,174 @@
+#ifndef __GEOMETRY_HPP__
+#define __GEOMETRY_HPP__
+
+#include <cstdio>
+#include <glad/gl.h>
+#include <memory>
+#include <ostream>
+#include <vector>
+
+#include "errorHandler.hpp"
+#include "vertexFormat.hpp"
+
+using Vertices = std::vector<GLfloat>;
+using Colors = std::vector<GLfloat>;
+using Uvs = std::vector<GLfloat>;
+using Normals = std::vector<GLfloat>;
+
+using Indices = std::vector<GLuint>;
+
+using Vbo = std::vector<GLfloat>;
+
+class Geometry;
+using GeometryPointer = std::shared_ptr<Geometry>;
+
+enum VboType{
+    VERTICES = 3,
+    COLORS = 4,
+    UVS = 2,
+    NORMALS = 3
+};
+
+/**
+ * A class holding the immutable static vertex stream (positions, uvs and normals) and its GPU buffers,
+ * shared by all the meshes using it
+*/
+class Geometry{
+    private:
+        /**
+         * The vertex buffer object
+        */
+        GLuint _VBO = 0;
+
+        /**
+         * The element buffer object
+        */
+        GLuint _EBO = 0;
+
+        /**
+         * Tell if the buffers have been sent to the GPU
+        */
+        GLboolean _IsUploaded = false;
+
+        /**
+         * The layout of the static stream on the GPU
+        */
+        VertexFormat _Format = VertexFormat::standard();
+
+        /**
+         * The number of vertices
+        */
+        GLuint _NbVertices = 0;
+
+        /**
+         * The interleaved static stream as floats (x, y, z, u, v, nx, ny, nz per vertex)
+        */
+        Vbo _VertexData = {};
+
+        /**
+         * The number of indices
+        */
+        GLuint _NbIndices = 0;
+
+        /**
+         * The indices
+        */
+        Indices _Indices = {};
+
+    private:
+        /**
+         * Interleave separate vertex arrays into a static stream
+         * @param vertices The vertices (as x, y, z values)
+         * @param uvs The vertices' uvs (as u, v values), filled with zeros if empty
+         * @param normals The vertices' normals (as nx, ny, nz values), filled with zeros if empty
+         * @return The interleaved static stream
+        */
+        static Vbo interleave(const Vertices& vertices, const Uvs& uvs, const Normals& normals);
+
+    public:
+        /**
+         * The number of floats per vertex inside the static stream
+        */
+        static const GLuint _NB_ELEMENT_PER_VERTICES;
+
+        /**
+         * A constructor taking an already interleaved static stream
+         * @param vertexData The interleaved vertices (as x, y, z, u, v, nx, ny, nz values)
+         * @param indices The triangle indices
+         * @param format The layout of the stream on the GPU
+        */
+        Geometry(Vbo vertexData, Indices indices, const VertexFormat& format = VertexFormat::standard());
+
+        /**
+         * Create a geometry by interleaving separate vertex arrays
+         * @param vertices The vertices (as x, y, z values)
+         * @param indices The triangle indices
+         * @param uvs The vertices' uvs (as u, v values)
+         * @param normals The vertices' normals (as nx, ny, nz values)
+         * @param format The layout of the stream on the GPU
+         * @return A new geometry
+        */
+        static GeometryPointer fromArrays(const Vertices& vertices, Indices indices, const Uvs& uvs = {}, const Normals& normals = {},
+                                            const VertexFormat& format = VertexFormat::standard()){
+            return GeometryPointer(new Geometry(interleave(vertices, uvs, normals), std::move(indices), format));
+        }
+
+        /**
+         * The GPU buffers can't be shared between copies
+        */
+        Geometry(const Geometry&) = delete;
+        Geometry& operator=(const Geometry&) = delete;
+
+        /**
+         * A basic destructor
+        */
+        ~Geometry(){
+            if(!_IsUploaded) return;
+            glDeleteBuffers(1, &_VBO);
+            glDeleteBuffers(1, &_EBO);
+        }
+
+        /**
+         * Send the vertex data to the GPU if it has not been done yet
+        */
+        void upload();
+
+        /**
+         * Bind the buffers and set the static per vertex attributes of the bound vertex array
+         * @cond The geometry must have been uploaded
+         * @see upload
+        */
+        void bindAttributes() const;
+
+        /**
+         * Get the number of vertices
+         * @return The number of vertices
+        */
+        GLuint getNbVertices() const {
+            return _NbVertices;
+        }
+
+        /**
+         * Get the layout of the static stream
+         * @return The vertex format
+        */
+        const VertexFormat& getFormat() const {
+            return _Format;
+        }
+
+        /**
+         * Get the number of indices
+         * @return The number of indices
+        */
+        GLuint getNbIndices() const {
+            return _NbIndices;
+        }
+
+        /**
+         * Display the geometry
+         * @param stream TO stream in which to display the geometry
+        */
+        void print(std::ostream& stream) const;
+};
+
+#endif
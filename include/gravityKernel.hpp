@@ -0,0 +1,50 @@
+#ifndef __GRAVITY_KERNEL_HPP__
+#define __GRAVITY_KERNEL_HPP__
+
+#include <glad/gl.h>
+
+#include "simdLevel.hpp"
+
+/**
+ * The structure of arrays read and written by the direct gravity kernel, one entry per body
+*/
+struct GravityBatch{
+    /**
+     * The number of bodies
+    */
+    GLuint _NbBodies;
+
+    /**
+     * The positions
+    */
+    const GLfloat* _X;
+    const GLfloat* _Y;
+    const GLfloat* _Z;
+
+    /**
+     * The masses
+    */
+    const GLfloat* _Masses;
+
+    /**
+     * The accelerations, written
+    */
+    GLfloat* _AccelerationsX;
+    GLfloat* _AccelerationsY;
+    GLfloat* _AccelerationsZ;
+};
+
+/**
+ * Compute the exact gravitational acceleration of a range of bodies, pulled by every body, several bodies at a time.
+ * The pulling bodies are swept by tiles that stay in the cache while the whole range goes over them
+ * @param batch The bodies' arrays
+ * @param gravitationalConstant The gravitational constant
+ * @param softening The Plummer softening length, positive
+ * @param first The index of the first body
+ * @param last The index after the last body
+ * @param level The instruction set to use, it falls back to the best supported one
+*/
+void computeGravity(const GravityBatch& batch, GLfloat gravitationalConstant, GLfloat softening,
+                    GLuint first, GLuint last, SimdLevel level = detectSimdLevel());
+
+#endif
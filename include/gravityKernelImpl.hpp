@@ -0,0 +1,103 @@
+#ifndef __GRAVITY_KERNEL_IMPL_HPP__
+#define __GRAVITY_KERNEL_IMPL_HPP__
+
+/**
+ * The body of the direct gravity kernel, written once for every instruction set.
+ * Only included by the kernel's translation units, in an anonymous namespace like the lanes
+ * @see simdLanes.hpp
+*/
+
+#include <algorithm>
+#include <glad/gl.h>
+
+#include "gravityKernel.hpp"
+#include "simdLanes.hpp"
+
+/**
+ * Compute a range of bodies with AVX2
+ * @param batch The bodies' arrays
+ * @param gravitationalConstant The gravitational constant
+ * @param softening The Plummer softening length
+ * @param first The index of the first body
+ * @param last The index after the last body
+ * @return False if the kernel was not compiled with AVX2
+*/
+bool computeGravityAvx2(const GravityBatch& batch, GLfloat gravitationalConstant, GLfloat softening, GLuint first, GLuint last);
+
+namespace {
+
+/**
+ * The number of pulling bodies in a tile, their positions and masses fill 16 KB of the L1 cache
+*/
+const static GLuint kGravityTile = 1024;
+
+/**
+ * Add the pull of a tile of bodies to L::Width consecutive bodies
+ * @param batch The bodies' arrays
+ * @param softening2 The squared softening length
+ * @param first The index of the first pulled body
+ * @param tileFirst The first pulling body
+ * @param tileLast The body after the last pulling one
+*/
+template <typename L>
+SIMD_KERNEL_TARGET inline void pullBlock(const GravityBatch& batch, GLfloat softening2, GLuint first, GLuint tileFirst, GLuint tileLast){
+    using F = typename L::F;
+    const F x = L::load(batch._X+first);
+    const F y = L::load(batch._Y+first);
+    const F z = L::load(batch._Z+first);
+    const F epsilon2 = L::set1(softening2);
+    F ax = L::load(batch._AccelerationsX+first);
+    F ay = L::load(batch._AccelerationsY+first);
+    F az = L::load(batch._AccelerationsZ+first);
+    for(GLuint j=tileFirst; j<tileLast; j++){
+        // a += m d / (|d|^2 + epsilon^2)^(3/2), a body adds nothing to itself since d = 0
+        const F dx = L::sub(L::set1(batch._X[j]), x);
+        const F dy = L::sub(L::set1(batch._Y[j]), y);
+        const F dz = L::sub(L::set1(batch._Z[j]), z);
+        const F r2 = L::fmadd(dx, dx, L::fmadd(dy, dy, L::fmadd(dz, dz, epsilon2)));
+        const F inverse = L::rsqrt(r2);
+        const F strength = L::mul(L::mul(L::set1(batch._Masses[j]), inverse), L::mul(inverse, inverse));
+        ax = L::fmadd(strength, dx, ax);
+        ay = L::fmadd(strength, dy, ay);
+        az = L::fmadd(strength, dz, az);
+    }
+    L::store(batch._AccelerationsX+first, ax);
+    L::store(batch._AccelerationsY+first, ay);
+    L::store(batch._AccelerationsZ+first, az);
+}
+
+/**
+ * Compute the accelerations of a range of bodies, L::Width at a time
+ * @param batch The bodies' arrays
+ * @param gravitationalConstant The gravitational constant
+ * @param softening The Plummer softening length
+ * @param first The index of the first body
+ * @param last The index after the last body
+*/
+template <typename L>
+SIMD_KERNEL_TARGET inline void computeRange(const GravityBatch& batch, GLfloat gravitationalConstant, GLfloat softening, GLuint first, GLuint last){
+    const GLfloat softening2 = softening * softening;
+    std::fill(batch._AccelerationsX+first, batch._AccelerationsX+last, 0.0f);
+    std::fill(batch._AccelerationsY+first, batch._AccelerationsY+last, 0.0f);
+    std::fill(batch._AccelerationsZ+first, batch._AccelerationsZ+last, 0.0f);
+    // each tile of pulling bodies is read from the cache by the whole range
+    for(GLuint tile=0; tile<batch._NbBodies; tile+=kGravityTile){
+        const GLuint tileLast = std::min(tile+kGravityTile, batch._NbBodies);
+        GLuint i = first;
+        for(; i+L::Width <= last; i+=L::Width){
+            pullBlock<L>(batch, softening2, i, tile, tileLast);
+        }
+        for(; i<last; i++){
+            pullBlock<ScalarLanes>(batch, softening2, i, tile, tileLast);
+        }
+    }
+    for(GLuint i=first; i<last; i++){
+        batch._AccelerationsX[i] *= gravitationalConstant;
+        batch._AccelerationsY[i] *= gravitationalConstant;
+        batch._AccelerationsZ[i] *= gravitationalConstant;
+    }
+}
+
+}
+
+#endif
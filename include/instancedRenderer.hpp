@@ -0,0 +1,182 @@
+#ifndef __INSTANCED_RENDERER_HPP__
+#define __INSTANCED_RENDERER_HPP__
+
+#include <glad/gl.h>
+#include <glm/glm.hpp>
+#include <map>
+#include <memory>
+#include <tuple>
+#include <vector>
+
+#include "mesh.hpp"
+#include "shaders.hpp"
+
+class InstancedRenderer;
+using InstancedRendererPointer = std::unique_ptr<InstancedRenderer>;
+
+/**
+ * @enum The locations of the per instance attributes in the vertex shader
+*/
+enum InstanceAttribute{
+    INSTANCE_MODEL = 4, // a mat4 uses the locations 4 to 7
+    INSTANCE_COLOR = 8,
+    INSTANCE_MATERIAL = 9,
+    INSTANCE_USE_TEX = 10,
+};
+
+/**
+ * The per instance data read by the vertex shader
+*/
+struct InstanceData{
+    /**
+     * The model matrix
+    */
+    glm::mat4 _Model = glm::mat4(1.0f);
+
+    /**
+     * The color multiplied with the vertex colors
+    */
+    glm::vec4 _Color = glm::vec4(1.0f);
+
+    /**
+     * The material (ambient, diffuse, specular, shininess)
+    */
+    glm::vec4 _Material = glm::vec4(0.0f);
+
+    /**
+     * 1 if the albedo texture must be used, 0 otherwise
+    */
+    GLfloat _UseTex = 0.0f;
+};
+
+using Instances = std::vector<InstanceData>;
+
+/**
+ * A set of instances drawn with a single draw call
+*/
+struct InstanceBatch{
+    /**
+     * The mesh whose vertex streams are shared by all the instances
+    */
+    MeshPointer _Mesh = nullptr;
+
+    /**
+     * The shader used to draw the instances
+    */
+    ShadersPointer _Shader = nullptr;
+
+    /**
+     * The albedo texture (0 if none)
+    */
+    GLuint _TexId = 0;
+
+    /**
+     * The sampler of the albedo texture (0 if none)
+    */
+    GLuint _SamplerId = 0;
+
+    /**
+     * The vertex array object combining the mesh streams and the instance buffer
+    */
+    GLuint _VAO = 0;
+
+    /**
+     * The instances submitted this frame
+    */
+    Instances _Instances = {};
+};
+
+/**
+ * A class drawing all the entities sharing vertex streams with one glDrawElementsInstanced per batch
+*/
+class InstancedRenderer{
+
+    private:
+        using BatchKey = std::tuple<const Geometry*, GLuint, const Shaders*, GLuint, GLuint>;
+
+        /**
+         * The batches
+        */
+        std::vector<InstanceBatch> _Batches = {};
+
+        /**
+         * The index of the batch of each geometry, color stream, shader, texture and sampler
+        */
+        std::map<BatchKey, size_t> _BatchIndices = {};
+
+        /**
+         * The buffer holding the instances of all the batches
+        */
+        GLuint _InstanceVBO = 0;
+
+        /**
+         * The size in bytes of the instance buffer
+        */
+        GLsizeiptr _Capacity = 0;
+
+    public:
+        /**
+         * A basic constructor
+        */
+        InstancedRenderer(){
+            glGenBuffers(1, &_InstanceVBO);
+        }
+
+        /**
+         * A basic destructor
+        */
+        ~InstancedRenderer();
+
+        /**
+         * Add an instance to draw this frame
+         * @param mesh The mesh whose vertex streams are shared by the instances
+         * @param shader The shader to use
+         * @param texId The albedo texture (0 if none)
+         * @param samplerId The sampler of the albedo texture (0 if none)
+         * @param instance The instance data
+        */
+        void submit(const MeshPointer& mesh, const ShadersPointer& shader, GLuint texId, GLuint samplerId, const InstanceData& instance);
+
+        /**
+         * Upload the instances and draw every batch, then empty the batches.
+         * The batches without instances this frame are removed, releasing their meshes
+        */
+        void flush();
+
+        /**
+         * Set the instance attributes as constant values for non instanced draws
+         * @param instance The instance data
+        */
+        static void setConstantInstance(const InstanceData& instance){
+            for(GLuint i=0; i<4; i++){
+                glVertexAttrib4fv(InstanceAttribute::INSTANCE_MODEL+i, &instance._Model[i][0]);
+            }
+            glVertexAttrib4fv(InstanceAttribute::INSTANCE_COLOR, &instance._Color[0]);
+            glVertexAttrib4fv(InstanceAttribute::INSTANCE_MATERIAL, &instance._Material[0]);
+            glVertexAttrib1f(InstanceAttribute::INSTANCE_USE_TEX, instance._UseTex);
+        }
+
+    private:
+        /**
+         * Create a new batch and its vertex array object
+         * @param mesh The mesh whose vertex streams are shared by the instances
+         * @param shader The shader to use
+         * @param texId The albedo texture (0 if none)
+         * @param samplerId The sampler of the albedo texture (0 if none)
+         * @return The index of the batch
+        */
+        size_t createBatch(const MeshPointer& mesh, const ShadersPointer& shader, GLuint texId, GLuint samplerId);
+
+        /**
+         * Remove the batches without instances, their vertex array objects are deleted
+        */
+        void removeEmptyBatches();
+
+        /**
+         * Point the instance attributes of the bound vertex array to a part of the instance buffer
+         * @param offset The offset in bytes of the first instance of the batch
+        */
+        void setInstanceAttributes(GLsizeiptr offset) const;
+};
+
+#endif
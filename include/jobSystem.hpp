@@ -0,0 +1,173 @@
+#ifndef __JOB_SYSTEM_HPP__
+#define __JOB_SYSTEM_HPP__
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <glad/gl.h>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class JobSystem;
+using JobSystemPointer = std::shared_ptr<JobSystem>;
+
+using Job = std::function<void()>;
+using RangeJob = std::function<void(GLuint, GLuint)>;
+
+/**
+ * A double ended queue of jobs: its owner works on the back, the other threads steal from the front
+*/
+class JobQueue{
+    private:
+        /**
+         * The jobs
+        */
+        std::deque<Job> _Jobs = {};
+
+        /**
+         * The lock protecting the jobs
+        */
+        std::mutex _Mutex;
+
+    public:
+        /**
+         * Add a job at the back
+         * @param job The job to add
+        */
+        void push(Job job){
+            std::lock_guard<std::mutex> lock(_Mutex);
+            _Jobs.push_back(std::move(job));
+        }
+
+        /**
+         * Take the newest job, for the owner
+         * @param job Set to the job taken
+         * @return False if the queue is empty
+        */
+        bool pop(Job& job){
+            std::lock_guard<std::mutex> lock(_Mutex);
+            if(_Jobs.empty()) return false;
+            job = std::move(_Jobs.back());
+            _Jobs.pop_back();
+            return true;
+        }
+
+        /**
+         * Take the oldest job, for the other threads
+         * @param job Set to the job taken
+         * @return False if the queue is empty
+        */
+        bool steal(Job& job){
+            std::lock_guard<std::mutex> lock(_Mutex);
+            if(_Jobs.empty()) return false;
+            job = std::move(_Jobs.front());
+            _Jobs.pop_front();
+            return true;
+        }
+};
+
+/**
+ * A fixed pool of worker threads sharing jobs through work stealing
+*/
+class JobSystem{
+    private:
+        /**
+         * The static instance of the job system
+        */
+        static JobSystemPointer _Instance;
+
+        /**
+         * The worker threads
+        */
+        std::vector<std::thread> _Workers = {};
+
+        /**
+         * One queue per worker, plus the queue of the other threads at index 0
+        */
+        std::vector<std::unique_ptr<JobQueue>> _Queues = {};
+
+        /**
+         * The number of jobs waiting in the queues
+        */
+        std::atomic<GLint> _NbPending{0};
+
+        /**
+         * Tell the workers to stop
+        */
+        std::atomic<bool> _IsStopping{false};
+
+        /**
+         * The lock and condition the idle workers sleep on
+        */
+        std::mutex _SleepMutex;
+        std::condition_variable _WakeUp;
+
+    private:
+        /**
+         * Start the workers
+         * @param nbWorkers The number of worker threads
+        */
+        JobSystem(GLuint nbWorkers);
+
+        /**
+         * The loop of a worker thread
+         * @param index The worker's queue index
+        */
+        void work(GLuint index);
+
+        /**
+         * Take a job, from the thread's own queue first then from the others
+         * @param index The thread's queue index
+         * @param job Set to the job taken
+         * @return False if every queue is empty
+        */
+        bool take(GLuint index, Job& job);
+
+        /**
+         * Add a job to a queue and wake a worker up
+         * @param index The queue index
+         * @param job The job
+        */
+        void submit(GLuint index, Job job);
+
+    public:
+        /**
+         * Stop and join the workers
+        */
+        ~JobSystem();
+
+        /**
+         * Get the unique instance of the job system, with one worker per hardware thread but the caller's
+         * @return The instance
+        */
+        static JobSystemPointer getInstance(){
+            if(!_Instance){
+                GLuint nbThreads = std::thread::hardware_concurrency();
+                _Instance = JobSystemPointer(new JobSystem(nbThreads > 1 ? nbThreads-1 : 0));
+            }
+            return _Instance;
+        }
+
+        /**
+         * Get the number of worker threads
+         * @return The number of workers
+        */
+        GLuint getNbWorkers() const {
+            return _Workers.size();
+        }
+
+        /**
+         * Run a function over a range split in chunks, in parallel, and wait for all of them.
+         * The calling thread runs jobs too while it waits
+         * @param first The first index
+         * @param last The index after the last one
+         * @param grain The maximal number of indices per chunk
+         * @param job The function called on each chunk with its first and last indices
+        */
+        void parallelFor(GLuint first, GLuint last, GLuint grain, const RangeJob& job);
+};
+
+#endif
@@ -0,0 +1,174 @@
+#ifndef __JSON_READER_HPP__
+#define __JSON_READER_HPP__
+
+#include <glad/gl.h>
+#include <string>
+#include <vector>
+
+/**
+ * @enum The tokens read from a JSON text
+*/
+enum JsonToken{
+    JSON_OBJECT_BEGIN,
+    JSON_OBJECT_END,
+    JSON_ARRAY_BEGIN,
+    JSON_ARRAY_END,
+    JSON_KEY,
+    JSON_STRING,
+    JSON_NUMBER,
+    JSON_BOOLEAN,
+    JSON_NULL,
+    JSON_END,
+    JSON_ERROR,
+};
+
+/**
+ * A streaming JSON parser: the tokens are pulled one at a time and no tree is built.
+ * The strings are read in place, only copied when asked for
+*/
+class JsonReader{
+    private:
+        /**
+         * The whole text, read at once
+        */
+        std::string _Text = "";
+
+        /**
+         * The next character to read
+        */
+        const char* _Cursor = nullptr;
+
+        /**
+         * The end of the text
+        */
+        const char* _End = nullptr;
+
+        /**
+         * The open objects ('{') and arrays ('[')
+        */
+        std::vector<char> _Containers = {};
+
+        /**
+         * Tell if the next string of the current object is a key
+        */
+        GLboolean _IsKeyExpected = false;
+
+        /**
+         * Tell if a value has just been read in a container, a separator must follow
+        */
+        GLboolean _IsSeparatorExpected = false;
+
+        /**
+         * Tell if the root value has been read
+        */
+        GLboolean _IsDone = false;
+
+        /**
+         * The raw characters of the last string or key, without the quotes
+        */
+        const char* _StringBegin = nullptr;
+        const char* _StringEnd = nullptr;
+
+        /**
+         * Tell if the last string contains escape sequences
+        */
+        GLboolean _HasEscapes = false;
+
+        /**
+         * The last number read
+        */
+        GLdouble _Number = 0.0;
+
+        /**
+         * The last boolean read
+        */
+        GLboolean _Boolean = false;
+
+        /**
+         * The line of the cursor, for the error messages
+        */
+        GLuint _Line = 1;
+
+    private:
+        /**
+         * Skip the spaces, counting the lines
+        */
+        void skipWhitespace();
+
+        /**
+         * Read a string after its opening quote
+         * @return True if the string is closed
+        */
+        GLboolean readString();
+
+        /**
+         * Read a literal word
+         * @param word The expected word
+         * @return True if the word is there
+        */
+        GLboolean readWord(const char* word);
+
+        /**
+         * Mark the end of a value
+        */
+        void endValue();
+
+    public:
+        /**
+         * Read a whole file in memory
+         * @param fileName The file's path
+         * @return True if the file has been read
+        */
+        GLboolean open(const std::string& fileName);
+
+        /**
+         * Read the next token
+         * @return The token, JSON_END after the root value, JSON_ERROR if the text is malformed
+        */
+        JsonToken next();
+
+        /**
+         * Skip the next value, with all its content
+         * @return False if the text is malformed
+        */
+        GLboolean skipValue();
+
+        /**
+         * Compare the last string or key, without copying it
+         * @param value The expected string, without escape sequences
+         * @return True if they are equal
+        */
+        GLboolean isString(const char* value) const;
+
+        /**
+         * Get the last string or key
+         * @return The string, with its escape sequences decoded
+        */
+        std::string getString() const;
+
+        /**
+         * Get the last number
+         * @return The number
+        */
+        GLdouble getNumber() const {
+            return _Number;
+        }
+
+        /**
+         * Get the last boolean
+         * @return The boolean
+        */
+        GLboolean getBoolean() const {
+            return _Boolean;
+        }
+
+        /**
+         * Get the line being read
+         * @return The line, starting at 1
+        */
+        GLuint getLine() const {
+            return _Line;
+        }
+};
+
+#endif
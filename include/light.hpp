@@ -8,6 +8,7 @@
 #include <memory>
 
 #include "entity.hpp"
+#include "uniformBlocks.hpp"
 
 class Light;
 using LightPointer = std::shared_ptr<Light>;
@@ -39,9 +40,9 @@ class Light{
         LightType _Type = PointLight;
 
         /**
-         * The entity containing the light
+         * The entity containing the light, not kept alive by it
         */
-        EntityPointer _Entity = nullptr;
+        std::weak_ptr<Entity> _Entity = {};
 
 
     public:
@@ -50,29 +51,37 @@ class Light{
          * @param type The type of light
          * @param pos The light's position
          * @param col The light's color
-         * @param entity The entity containing the light
+         * @param entity The entity containing the light, it can be set later
         */
-        Light(LightType type, const glm::vec3& pos, const glm::vec3& col, const EntityPointer& entity){
+        Light(LightType type, const glm::vec3& pos, const glm::vec3& col, const EntityPointer& entity = nullptr){
             _Type = type;
             _Position = pos;
             _Color = col;
             _Entity = entity;
         }
 
+        /**
+         * Set the entity containing the light
+         * @param entity The entity, the light doesn't keep it alive
+        */
+        void setEntity(const EntityPointer& entity){
+            _Entity = entity;
+        }
 
         /**
-         * Send the light to the gpu
-         * @param shader The shader to use
-         * @param name The name of the light
+         * Get the light as laid out in the lights uniform block
+         * @return The light with its position relative to the render origin
         */
-        void sendGPU(const ShadersPointer& shader, const std::string& name){
-            if(!_Entity){
+        LightData getData() const {
+            const EntityPointer entity = _Entity.lock();
+            if(!entity){
                 fprintf(stderr, "The entity must be initialized to setup the light!\n");
                 ErrorHandler::handle(ErrorCodes::NOT_INITALIZED);
             }
-            shader->setVec3f(name + ".position", _Position);
-            shader->setVec3f(name + ".color", _Color);
-            shader->setMat4f(name + ".model", _Entity->getModel());
+            LightData data;
+            data._Position = entity->getRenderModel() * glm::vec4(_Position, 1.0f);
+            data._Color = glm::vec4(_Color, 1.0f);
+            return data;
         }
 
         /**
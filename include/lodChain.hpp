@@ -0,0 +1,131 @@
+#ifndef __LOD_CHAIN_HPP__
+#define __LOD_CHAIN_HPP__
+
+#include <cstdio>
+#include <glad/gl.h>
+#include <memory>
+#include <vector>
+
+#include "errorHandler.hpp"
+#include "mesh.hpp"
+
+class LodChain;
+using LodChainPointer = std::shared_ptr<LodChain>;
+
+/**
+ * A level of detail: a mesh and the projected size from which it is used
+*/
+struct LodLevel{
+    /**
+     * The mesh of this level
+    */
+    MeshPointer _Mesh = nullptr;
+
+    /**
+     * The projected radius, in pixels, from which this level is used
+    */
+    GLfloat _MinRadius = 0.0f;
+};
+
+using LodLevels = std::vector<LodLevel>;
+
+/**
+ * The resolution of a sphere level and the projected size from which it is used
+*/
+struct SphereLod{
+    GLuint _Resolution;
+    GLfloat _MinRadius;
+};
+
+/**
+ * A class holding meshes of decreasing detail for the same shape
+*/
+class LodChain{
+    private:
+        /**
+         * The levels, from the coarsest to the finest
+        */
+        LodLevels _Levels = {};
+
+        /**
+         * The relative margin around a threshold before switching levels, avoiding popping
+        */
+        GLfloat _Hysteresis = 0.15f;
+
+    public:
+        /**
+         * A basic constructor
+         * @param levels The levels, sorted by increasing minimal radius
+         * @param hysteresis The relative margin around a threshold before switching levels
+        */
+        LodChain(LodLevels levels, GLfloat hysteresis = 0.15f){
+            if(levels.empty()){
+                fprintf(stderr, "A level of detail chain needs at least one level!\n");
+                ErrorHandler::handle(ErrorCodes::BAD_VALUE);
+            }
+            for(size_t i=1; i<levels.size(); i++){
+                if(levels[i]._MinRadius <= levels[i-1]._MinRadius){
+                    fprintf(stderr, "The levels of detail must be sorted by increasing projected radius!\n");
+                    ErrorHandler::handle(ErrorCodes::BAD_VALUE);
+                }
+            }
+            _Levels = std::move(levels);
+            _Hysteresis = hysteresis;
+        }
+
+        /**
+         * Create a chain of spheres sharing the same tessellation
+         * @param type The way the spheres are tessellated
+         * @param lods The resolution and minimal projected radius of each level
+         * @return A new chain
+        */
+        static LodChainPointer spheres(SphereType type, const std::vector<SphereLod>& lods){
+            LodLevels levels;
+            levels.reserve(lods.size());
+            for(const auto& lod : lods){
+                levels.push_back({Mesh::sphere(type, 1.0f, glm::vec3(0.0f), lod._Resolution), lod._MinRadius});
+            }
+            return LodChainPointer(new LodChain(std::move(levels)));
+        }
+
+        /**
+         * Select the level to use for a projected size
+         * @param projectedRadius The radius of the shape on the screen, in pixels
+         * @param current The level used until now
+         * @return The index of the level to use
+        */
+        GLuint select(GLfloat projectedRadius, GLuint current) const {
+            GLuint level = current < _Levels.size() ? current : _Levels.size()-1;
+            // go up only once well past the next threshold, and down only once well below the current one
+            while(level+1 < _Levels.size() && projectedRadius > _Levels[level+1]._MinRadius*(1.0f + _Hysteresis)){
+                level++;
+            }
+            while(level > 0 && projectedRadius < _Levels[level]._MinRadius*(1.0f - _Hysteresis)){
+                level--;
+            }
+            return level;
+        }
+
+        /**
+         * Get the number of levels
+         * @return The number of levels
+        */
+        GLuint getNbLevels() const {
+            return _Levels.size();
+        }
+
+        /**
+         * Get the mesh of a level
+         * @param level The index of the level
+         * @return The mesh
+        */
+        MeshPointer getMesh(GLuint level) const {
+            if(level >= _Levels.size()){
+                fprintf(stderr, "Level %d out of range, the chain has %d levels!\n", level, (int)_Levels.size());
+                ErrorHandler::handle(ErrorCodes::OUT_OF_RANGE);
+            }
+            return _Levels[level]._Mesh;
+        }
+};
+
+#endif
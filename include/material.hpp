@@ -5,7 +5,6 @@
 #include <memory>
 #include "errorHandler.hpp"
 #include "glad/gl.h"
-#include "shaders.hpp"
 
 
 class Material;
@@ -70,16 +69,11 @@ class Material{
         }
 
         /**
-         * Set the values for a given shader
-         * @param shader The shader to use
-         * @cond Shader must have the correct "fAmbient", "fDiffuse", "fSpecular" and "fShininess" variables
+         * Get the material as sent to the shaders
+         * @return The ambient, diffuse, specular and shininess values
         */
-        void setShaderValues(const ShadersPointer& shader){
-            shader->use();
-            shader->setFloat("fAmbient", _Ambient);
-            shader->setFloat("fDiffuse", _Diffuse);
-            shader->setFloat("fSpecular", _Specular);
-            shader->setFloat("fShininess", _Shininess);
+        glm::vec4 getParameters() const {
+            return glm::vec4(_Ambient, _Diffuse, _Specular, _Shininess);
         }
 
         /**
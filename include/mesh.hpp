@@ -11,279 +11,198 @@
 #include <glm/glm.hpp>
 
 #include "errorHandler.hpp"
+#include "geometry.hpp"
 #include "glm/geometric.hpp"
 
-using Vertices = std::vector<GLfloat>;
-using Colors = std::vector<GLfloat>;
-using Uvs = std::vector<GLfloat>;
-using Normals = std::vector<GLfloat>;
-
-using Indices = std::vector<GLuint>;
-
-using Vbo = std::vector<GLfloat>;
-
 class Mesh;
 using MeshPointer = std::shared_ptr<Mesh>;
 
-enum VboType{
-    VERTICES = 3,
-    COLORS = 4,
-    UVS = 2,
-    NORMALS = 3
+/**
+ * @enum The different ways to tessellate a sphere
+*/
+enum SphereType{
+    UV_SPHERE,
+    ICO_SPHERE,
+    CUBE_SPHERE,
 };
 
 /**
- * A class that handle the mesh
+ * A class that handle the mesh: a shared static geometry stream plus its own color,
+ * either as a per vertex color stream or as a constant color
 */
 class Mesh{
     private:
-        /**
-         * The number of elements per vertices inside the vbo
-        */
-        static const GLuint _NB_ELEMENT_PER_VERTICES;
-
         /**
          * The vertex array object
         */
         GLuint _VAO = 0;
 
         /**
-         * The vertex buffer object
-        */
-        GLuint _VBO = 0;
-
-        /**
-         * The element buffer object
-        */
-        GLuint _EBO = 0;
-
-        /**
-         * The number of vertices
+         * The static vertex data, possibly shared with other meshes
         */
-        GLuint _NbVertices = 0;
+        GeometryPointer _Geometry = nullptr;
 
         /**
-         * The vertex positions
+         * The constant color used when the mesh has no color stream
         */
-        Vertices _Vertices = {};
+        glm::vec4 _Color = glm::vec4(1.0f);
 
         /**
-         * The vertex colors
+         * The per vertex colors (empty if the mesh uses its constant color)
         */
         Colors _Colors = {};
 
         /**
-         * The vertex uvs
+         * The vertex buffer object of the color stream
         */
-        Uvs _Uvs = {};
+        GLuint _ColorVBO = 0;
 
         /**
-         * The vertex normals
+         * Tell if the color stream must be sent to the GPU again
         */
-        Normals _Normals = {};
+        GLboolean _IsColorStreamDirty = false;
 
+    private:
         /**
-         * The number of indices
+         * Create the vertex array object pointing to the geometry and color buffers
         */
-        GLuint _NbIndices = 0;
+        void createVAO() {
+            initGpuGeometry();
+            glGenVertexArrays(1, &_VAO);
+            glBindVertexArray(_VAO);
+            bindAttributes();
+            glBindVertexArray(0);
+        }
 
         /**
-         * The indices
+         * Send the color stream to the GPU
         */
-        Indices _Indices = {};
+        void sendColorStream() {
+            _IsColorStreamDirty = false;
+            if(_Colors.empty()) return;
+            if(!_ColorVBO) glGenBuffers(1, &_ColorVBO);
+            VertexBytes colorData = VertexFormat::colors().encode(_Colors.data(), _Colors.size()/VboType::COLORS);
+            glBindBuffer(GL_ARRAY_BUFFER, _ColorVBO);
+            glBufferData(GL_ARRAY_BUFFER, colorData.size(), colorData.data(), GL_STATIC_DRAW);
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+        }
 
-        /**
-         * The vbo
-        */
-        Vbo _VboData = {};
+    public:
 
-    private:
         /**
-         * Create the vbo
-         * @return The vbo as a floating point vector
+         * A constructor to initialize and bind everything
+         * @param vertices The vertices (as x, y, z values)
+         * @param indices The triangle indices
+         * @param colors The vertices' colors (as r, g, b, a values), the mesh is white if empty
+         * @param uvs The vertices' uvs (as u, v values)
+         * @param normals The vertices' normals (as nx, ny, nz values)
+         * @param format The layout of the static stream on the GPU
         */
-        void createVBO() {
-            const GLuint size = _NbVertices*_NB_ELEMENT_PER_VERTICES;
-            _VboData = Vbo(_NbVertices * _NB_ELEMENT_PER_VERTICES);
-
-            for(int i=0; i<_NbVertices; i++){
-                const GLuint idx   = i*_NB_ELEMENT_PER_VERTICES;
-                const GLuint vIdx  = i*VboType::VERTICES;
-                const GLuint cIdx  = i*VboType::COLORS;
-                const GLuint uvIdx = i*VboType::UVS;
-                const GLuint nIdx  = i*VboType::NORMALS;
-
-                // set the vertices
-                _VboData[idx]    = _Vertices[vIdx];
-                _VboData[idx+1]  = _Vertices[vIdx+1];
-                _VboData[idx+2]  = _Vertices[vIdx+2];
-                // set the colors
-                _VboData[idx+3]  = _Colors[cIdx];
-                _VboData[idx+4]  = _Colors[cIdx+1];
-                _VboData[idx+5]  = _Colors[cIdx+2];
-                _VboData[idx+6]  = _Colors[cIdx+3];
-                // set the uvs
-                _VboData[idx+7]  = _Uvs[uvIdx];
-                _VboData[idx+8]  = _Uvs[uvIdx+1];
-                // set the normals
-                _VboData[idx+9]  = _Normals[nIdx];
-                _VboData[idx+10] = _Normals[nIdx+1];
-                _VboData[idx+11] = _Normals[nIdx+2];
-            }
+        Mesh(const Vertices& vertices, Indices indices, Colors colors = {}, const Uvs& uvs = {}, const Normals& normals = {},
+                const VertexFormat& format = VertexFormat::standard()){
+            _Geometry = Geometry::fromArrays(vertices, std::move(indices), uvs, normals, format);
+            if(!colors.empty()) setColors(std::move(colors));
         }
 
         /**
-         * Bind the vbo and put the vertices data in it
+         * A constructor around an existing static stream
+         * @param geometry The static vertex data
         */
-        void sendVBO() {
-            if(_Vertices.empty()){
-                fprintf(stderr, "Can't create GPU buffers without vertices!\n");
-                ErrorHandler::handle(ErrorCodes::NOT_INITALIZED);
-            }
-            // create the vbo
-            createVBO();
-
-            // bind the vbo
-            glBindBuffer(GL_ARRAY_BUFFER, _VBO);
-            glBufferData(GL_ARRAY_BUFFER, _VboData.size()*sizeof(GLfloat), _VboData.data(), GL_DYNAMIC_READ);
+        Mesh(const GeometryPointer& geometry){
+            _Geometry = geometry;
         }
 
         /**
-         * Bind the ebo and put the indices data in it
+         * A shallow copy constructor, the static vertex data is shared with the copied mesh
+         * @param mesh The mesh to copy
         */
-        void sendEBO() const {
-            if(_NbIndices==0){
-                fprintf(stderr, "Can't create GPU buffers without indices!\n");
-                ErrorHandler::handle(ErrorCodes::NOT_INITALIZED);
-            }
-            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _EBO);
-            glBufferData(GL_ELEMENT_ARRAY_BUFFER, _Indices.size()*sizeof(GLuint), _Indices.data(), GL_DYNAMIC_READ);
+        Mesh(const MeshPointer& mesh){
+            _Geometry = mesh->_Geometry;
+            _Color = mesh->_Color;
+            if(!mesh->_Colors.empty()) setColors(mesh->_Colors);
         }
 
         /**
-         * Bind the vao and put the necessary data in it
+         * A basic destructor
         */
-        void sendVAO() const {
-            GLsizei size = _NB_ELEMENT_PER_VERTICES * sizeof(float);
-            GLvoid* pointer = (void*)0;
-            GLuint id = 0;
-            // position attributes
-            glVertexAttribPointer(id, VboType::VERTICES, GL_FLOAT, GL_FALSE, size, pointer);
-            glEnableVertexAttribArray(id);
-            // color attributes
-            pointer = reinterpret_cast<GLvoid*>(VboType::VERTICES * sizeof(float));
-            id++;
-            glVertexAttribPointer(id, VboType::COLORS, GL_FLOAT, GL_FALSE, size, pointer);
-            glEnableVertexAttribArray(id);
-            // uv attributes
-            pointer = reinterpret_cast<GLvoid*>((VboType::VERTICES + VboType::COLORS) * sizeof(float));
-            id++;
-            glVertexAttribPointer(id, VboType::UVS, GL_FLOAT, GL_FALSE, size, pointer);
-            glEnableVertexAttribArray(id);
-            // normals attributes
-            pointer = reinterpret_cast<GLvoid*>((VboType::VERTICES + VboType::COLORS + VboType::UVS) * sizeof(float));
-            id++;
-            glVertexAttribPointer(id, VboType::NORMALS, GL_FLOAT, GL_FALSE, size, pointer);
-            glEnableVertexAttribArray(id);
+        ~Mesh(){
+            if(_VAO) glDeleteVertexArrays(1, &_VAO);
+            if(_ColorVBO) glDeleteBuffers(1, &_ColorVBO);
         }
 
-    private:
         /**
-         * An empty constructor
+         * Initiate the GPU geometry, the shared vertex data is only sent once
         */
-        Mesh(){
-            glGenVertexArrays(1, &_VAO);
-            glGenBuffers(1, &_VBO);
-            glGenBuffers(1, &_EBO);
+        void initGpuGeometry() {
+            _Geometry->upload();
+            if(!_IsColorStreamDirty) return;
+            sendColorStream();
+            // point the vao to the new color stream
+            if(_VAO){
+                glBindVertexArray(_VAO);
+                bindAttributes();
+                glBindVertexArray(0);
+            }
         }
 
-
-    public:
-
         /**
-         * A constructor to initialize and bind everything
-         * @param vertices The vertices (as x, y, z values)
-         * @param indices The triangle indices
-         * @param colors The vertices' colors (as r, g, b, a values)
-         * @param uvs The vertices' uvs (as u, v values)
-         * @param normals The vertices' normals (as nx, ny, nz values)
+         * Bind the mesh buffers and set the per vertex attributes of the bound vertex array
+         * @cond The GPU geometry must have been initialized
+         * @see initGpuGeometry
         */
-        Mesh(Vertices vertices, Indices indices, Colors colors = {}, Uvs uvs = {}, Normals normals = {}) : Mesh() {
-            // fill if empty lists
-            if(vertices.empty()){
-                fprintf(stderr, "Vertices can't be empty!\n");
-                ErrorHandler::handle(ErrorCodes::OUT_OF_RANGE);
-            }
-            if(indices.empty()){
-                fprintf(stderr, "Indices can't be empty!\n");
-                ErrorHandler::handle(ErrorCodes::OUT_OF_RANGE);
-            }
-            _NbVertices = vertices.size() / VboType::VERTICES;
-            if(colors.empty()) colors = Colors(_NbVertices*VboType::COLORS, 1.0f);
-            if(uvs.empty()) uvs     = Uvs(_NbVertices*VboType::UVS, 0.0f);
-            if(normals.empty()) normals = Normals(_NbVertices*VboType::NORMALS, 0.0f);
-
-            // check sizes
-            if(colors.size() != _NbVertices*VboType::COLORS){
-                fprintf(stderr, "The number of colors should correspond to the number of vertices! Given %d, expected: %d!\n", (int)colors.size(), _NbVertices*VboType::COLORS);
-                ErrorHandler::handle(ErrorCodes::OUT_OF_RANGE);
-            }
-            if(uvs.size() != _NbVertices*VboType::UVS){
-                fprintf(stderr, "The number of uvs should correspond to the number of vertices! Given %d, expected: %d!\n", (int)uvs.size(), _NbVertices*VboType::UVS);
-                ErrorHandler::handle(ErrorCodes::OUT_OF_RANGE);
-            }
-            if(normals.size() != _NbVertices*VboType::NORMALS){
-                fprintf(stderr, "The number of normals should correspond to the number of vertices! Given %d, expected: %d!\n", (int)normals.size(), _NbVertices*VboType::NORMALS);
-                ErrorHandler::handle(ErrorCodes::OUT_OF_RANGE);
+        void bindAttributes() const {
+            _Geometry->bindAttributes();
+            if(_Colors.empty()){
+                // the constant color is set as a generic attribute before drawing
+                glDisableVertexAttribArray(VertexAttribute::VERTEX_COLOR);
+                return;
             }
+            glBindBuffer(GL_ARRAY_BUFFER, _ColorVBO);
+            VertexFormat::colors().bindAttributes();
+        }
 
-            _Vertices = vertices;
-            _NbIndices = indices.size();
-            _Indices = indices;
-            _Colors = colors;
-            _Uvs = uvs;
-            _Normals = normals;
+        /**
+         * Get the number of indices
+         * @return The number of indices
+        */
+        GLuint getNbIndices() const {
+            return _Geometry->getNbIndices();
         }
 
         /**
-         * A basic shallow copy constructor
-         * @param mesh The mesh to copy
+         * Get the static vertex data
+         * @return A pointer to the geometry
         */
-        Mesh(const MeshPointer& mesh) : Mesh(){
-            _NbVertices = mesh->_NbVertices;
-            _Vertices = mesh->_Vertices;
-            _NbIndices = mesh->_NbIndices;
-            _Indices = mesh->_Indices;
-            _Colors = mesh->_Colors;
-            _Uvs = mesh->_Uvs;
-            _Normals = mesh->_Normals;
+        GeometryPointer getGeometry() const {
+            return _Geometry;
         }
 
         /**
-         * A basic destructor
+         * Get the color stream
+         * @return The vbo of the per vertex colors, 0 if the mesh uses a constant color
         */
-        ~Mesh(){
-            glDeleteVertexArrays(1, &_VAO);
-            glDeleteBuffers(1, &_VBO);
-            glDeleteBuffers(1, &_EBO);
+        GLuint getColorStream() const {
+            return _Colors.empty() ? 0 : _ColorVBO;
         }
 
         /**
-         * Initiate the GPU geometry
+         * Get the constant color of the mesh
+         * @return The constant color, white if the mesh has per vertex colors
         */
-        void initGpuGeometry() {
-            glBindVertexArray(_VAO);
-            sendVBO();
-            sendEBO();
-            sendVAO();
+        glm::vec4 getConstantColor() const {
+            return _Colors.empty() ? _Color : glm::vec4(1.0f);
         }
 
         /**
          * Render the mesh
         */
-        void render() const {
+        void render() {
+            // the vao is only needed when the mesh is not drawn through instancing
+            if(!_VAO) createVAO();
+            initGpuGeometry();
             glBindVertexArray(_VAO);
-            glDrawElements(GL_TRIANGLES, _NbIndices, GL_UNSIGNED_INT, 0);
+            if(_Colors.empty()) glVertexAttrib4fv(VertexAttribute::VERTEX_COLOR, &_Color[0]);
+            glDrawElements(GL_TRIANGLES, getNbIndices(), GL_UNSIGNED_INT, 0);
             glBindVertexArray(0);
         }
 
@@ -293,124 +212,80 @@ class Mesh{
          * @param radius The sphere's radius
          * @param center The sphere's center
          * @param resolution The sphere's resolution
-         * @return A new mesh
+         * @return A new mesh, using the packed vertex format
         */
-        static MeshPointer unitSphere(GLfloat radius = 1.0f, glm::vec3 center = glm::vec3(0.0f), GLuint resolution = 16){
-            if(resolution<3){
-                fprintf(stderr, "The resolution of a sphere must be at least 3!\n");
-                ErrorHandler::handle(ErrorCodes::BAD_VALUE);
-            }
-
-            Indices indices;
-            Vertices vertices;
-            Normals normals;
-            Uvs uvs;
-
-            const float PI = 3.1416f;
-            const float stepPhi = PI / resolution;
-            const float stepTheta = 2 * PI / resolution;
-            float phi = 0.0f;
-
-            int nbVertices = 0;
-
-            // Generate vertices
-            for (int i = 0; i <= resolution; i++) {
-                phi += stepPhi;
-                float theta = 0.0f;
-                for (int j = 0; j <= resolution; j++) {
-                    theta += stepTheta;
-
-                    float x = radius*sin(theta)*sin(phi) + center.x;
-                    float y = radius*cos(phi) + center.y;
-                    float z = radius*cos(theta)*sin(phi) + center.z;
-
-                    vertices.push_back(x);
-                    vertices.push_back(y);
-                    vertices.push_back(z);
-                    nbVertices++;
-
-                    // Generate textures
-                    uvs.push_back(j / (float)resolution);
-                    uvs.push_back(i / (float)resolution);
-                }
-            }
-
-            // Generate indices
-            for (int i = 0; i < resolution; i++) {
-                for (int j = 0; j < resolution; j++) {
-                    int first = i * (resolution + 1) + j;
-                    int second = first + resolution + 1;
-
-                    indices.push_back(first);
-                    indices.push_back(second);
-                    indices.push_back(first + 1);
-
-                    indices.push_back(second);
-                    indices.push_back(second + 1);
-                    indices.push_back(first + 1);
-                }
-            }
-
-            // Generate normals
-            for(int i=0; i<vertices.size(); i+=3){
-                glm::vec3 vert = glm::vec3(vertices[i], vertices[i+1], vertices[i+2]);
-                glm::vec3 norm = glm::normalize(vert-center);
-                normals.push_back(norm.x);
-                normals.push_back(norm.y);
-                normals.push_back(norm.z);
-            }
+        static MeshPointer unitSphere(GLfloat radius = 1.0f, glm::vec3 center = glm::vec3(0.0f), GLuint resolution = 16);
 
+        /**
+         * Generate a geodesic sphere by subdividing the faces of an icosahedron,
+         * the triangles are almost uniform (10*resolution^2+2 distinct positions)
+         * @param radius The sphere's radius
+         * @param center The sphere's center
+         * @param resolution The number of segments each edge of the icosahedron is split into
+         * @return A new mesh, using the packed vertex format
+        */
+        static MeshPointer icoSphere(GLfloat radius = 1.0f, glm::vec3 center = glm::vec3(0.0f), GLuint resolution = 4);
 
-            return MeshPointer(new Mesh(vertices, indices, {}, uvs, normals));
-        }
+        /**
+         * Generate a sphere by projecting the faces of a subdivided cube
+         * @param radius The sphere's radius
+         * @param center The sphere's center
+         * @param resolution The number of segments each edge of the cube is split into
+         * @return A new mesh, using the packed vertex format
+        */
+        static MeshPointer cubeSphere(GLfloat radius = 1.0f, glm::vec3 center = glm::vec3(0.0f), GLuint resolution = 6);
 
+        /**
+         * Generate a sphere of a given type
+         * @param type The way the sphere is tessellated
+         * @param radius The sphere's radius
+         * @param center The sphere's center
+         * @param resolution The sphere's resolution
+         * @return A new mesh, using the packed vertex format
+        */
+        static MeshPointer sphere(SphereType type, GLfloat radius = 1.0f, glm::vec3 center = glm::vec3(0.0f), GLuint resolution = 16);
 
         /**
          * Display the mesh
          * @param stream TO stream in which to display the mesh
         */
         void print(std::ostream& stream) const {
-            stream << "Vertices:\n";
-            for(int i=0; i<_NbVertices; i++){
-                stream << _Vertices[VERTICES*i] << " " << _Vertices[VERTICES*i+1] << " " << _Vertices[VERTICES*i+2] << "\n";
-            }
+            _Geometry->print(stream);
 
-            stream << "\nIndices:\n";
-            for(int i=0; i<_NbIndices; i+=3){
-                stream << _Indices[i] << " " << _Indices[i+1] << " " << _Indices[i+2] << "\n";
+            stream << "Colors:\n";
+            if(_Colors.empty()){
+                stream << _Color.r << " " << _Color.g << " " << _Color.b << " " << _Color.a << " (constant)\n";
             }
-
-            stream << "\nColors:\n";
-            for(int i=0; i<_NbVertices; i++){
-                stream << _Colors[COLORS*i] << " " << _Colors[COLORS*i+1] << " " << _Colors[COLORS*i+2] << " " << _Colors[COLORS*i+3] << "\n";
+            for(GLuint i=0; i<_Colors.size(); i+=VboType::COLORS){
+                stream << _Colors[i] << " " << _Colors[i+1] << " " << _Colors[i+2] << " " << _Colors[i+3] << "\n";
             }
-
-            stream << "\nUvs:\n";
-            for(int i=0; i<_NbVertices; i++){
-                stream << _Uvs[UVS*i] << " " << _Uvs[UVS*i+1] << "\n";
-            }
-
-            stream << "\nNormals:\n";
-            for(int i=0; i<_NbVertices; i++){
-                stream << _Normals[NORMALS*i] << " " << _Normals[NORMALS*i+1] << " " << _Normals[NORMALS*i+2] << "\n";
-            }
-
             stream << std::endl;
         }
 
         /**
          * Set a unique color for all the vertices
          * @param color The color to set
+         * @note No vertex data is rebuilt, the color is sent as a constant attribute
         */
         void setSimpleColor(glm::vec4 color){
-            Colors newColors = Colors(_Colors.size());
-            for(int i=0; i<_NbVertices; i++){
-                newColors[i*VboType::COLORS]   = color.r;
-                newColors[i*VboType::COLORS+1] = color.g;
-                newColors[i*VboType::COLORS+2] = color.b;
-                newColors[i*VboType::COLORS+3] = color.a;
+            _Color = color;
+            if(!_Colors.empty()){
+                _Colors.clear();
+                _IsColorStreamDirty = true;
+            }
+        }
+
+        /**
+         * Set a color per vertex in the mesh's own color stream
+         * @param colors The vertices' colors (as r, g, b, a values)
+        */
+        void setColors(Colors colors){
+            if(colors.size() != _Geometry->getNbVertices()*VboType::COLORS){
+                fprintf(stderr, "The number of colors should correspond to the number of vertices! Given %d, expected: %d!\n", (int)colors.size(), _Geometry->getNbVertices()*VboType::COLORS);
+                ErrorHandler::handle(ErrorCodes::OUT_OF_RANGE);
             }
-            _Colors = newColors;
+            _Colors = std::move(colors);
+            _IsColorStreamDirty = true;
         }
 
 };
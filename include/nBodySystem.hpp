@@ -0,0 +1,310 @@
+#ifndef __N_BODY_SYSTEM_HPP__
+#define __N_BODY_SYSTEM_HPP__
+
+#include <glad/gl.h>
+#include <glm/glm.hpp>
+#include <limits>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "bodyStore.hpp"
+#include "octree.hpp"
+
+class NBodySystem;
+using NBodySystemPointer = std::shared_ptr<NBodySystem>;
+
+/**
+ * The default gravitational constant, in the scene's units
+*/
+const static GLfloat kDefaultGravitationalConstant = 1.0f;
+
+/**
+ * The default Plummer softening length
+*/
+const static GLfloat kDefaultSoftening = 0.01f;
+
+/**
+ * The default Barnes-Hut opening angle, the ratio node size / distance under which a node is seen as a single mass
+*/
+const static GLfloat kDefaultOpeningAngle = 0.5f;
+
+/**
+ * The default accuracy of the adaptive steps: the step is this fraction of sqrt(softening / largest acceleration)
+*/
+const static GLfloat kDefaultStepAccuracy = 0.2f;
+
+/**
+ * The longest step out of the time budget, in accurate steps, the particles fall behind the clock beyond
+*/
+const static GLdouble kMaxStepStretch = 8.0;
+
+/**
+ * The time budget meaning no limit
+*/
+const static GLdouble kNoTimeBudget = std::numeric_limits<GLdouble>::infinity();
+
+/**
+ * The number of particles under which the forces are summed exactly, the tree doesn't pay off below it
+*/
+const static GLuint kDirectGravityLimit = 4096;
+
+/**
+ * @enum The ways of computing the forces
+*/
+enum GravitySolver{
+    GRAVITY_AUTO,
+    GRAVITY_DIRECT,
+    GRAVITY_BARNES_HUT,
+};
+
+/**
+ * Particles moving under their mutual gravity, integrated with a kick-drift-kick leapfrog.
+ * The forces are summed exactly in O(N^2) for the small systems and approximated with a Barnes-Hut octree
+ * in O(N log N) for the large ones.
+ * A particle can drive a body of the store, which then renders where the particle is
+*/
+class NBodySystem{
+    private:
+        /**
+         * The body driven by each particle, kInvalidBody for the particles only simulated
+        */
+        BodyHandles _Bodies = {};
+
+        /**
+         * The particle driving each body
+        */
+        std::unordered_map<BodyHandle, GLuint> _Particles = {};
+
+        /**
+         * The positions, in double precision so that the small steps aren't lost far from the origin
+        */
+        BodyDoubles _PositionsX = {};
+        BodyDoubles _PositionsY = {};
+        BodyDoubles _PositionsZ = {};
+
+        /**
+         * The positions relative to the first particle, in float for the forces which only need the differences
+        */
+        BodyFloats _RelativePositionsX = {};
+        BodyFloats _RelativePositionsY = {};
+        BodyFloats _RelativePositionsZ = {};
+
+        /**
+         * The velocities
+        */
+        BodyDoubles _VelocitiesX = {};
+        BodyDoubles _VelocitiesY = {};
+        BodyDoubles _VelocitiesZ = {};
+
+        /**
+         * The accelerations at the current positions
+        */
+        BodyFloats _AccelerationsX = {};
+        BodyFloats _AccelerationsY = {};
+        BodyFloats _AccelerationsZ = {};
+
+        /**
+         * The masses
+        */
+        BodyFloats _Masses = {};
+
+        /**
+         * The tree approximating the forces, rebuilt at each step
+        */
+        Octree _Tree;
+
+        /**
+         * The gravitational constant
+        */
+        GLfloat _GravitationalConstant = kDefaultGravitationalConstant;
+
+        /**
+         * The Plummer softening length
+        */
+        GLfloat _Softening = kDefaultSoftening;
+
+        /**
+         * The Barnes-Hut opening angle
+        */
+        GLfloat _OpeningAngle = kDefaultOpeningAngle;
+
+        /**
+         * The way of computing the forces
+        */
+        GravitySolver _Solver = GRAVITY_AUTO;
+
+        /**
+         * The fraction of sqrt(softening / largest acceleration) taken by the adaptive steps
+        */
+        GLfloat _StepAccuracy = kDefaultStepAccuracy;
+
+        /**
+         * The real time taken by the last step, in seconds
+        */
+        GLdouble _StepCost = 0.0;
+
+        /**
+         * Tell if the last advance took longer steps than the accuracy asks for, or fell behind, to stay in its time budget
+        */
+        GLboolean _IsDegraded = false;
+
+        /**
+         * The simulated time the particles have fallen behind the advances asked for
+        */
+        GLdouble _Lag = 0.0;
+
+        /**
+         * Tell if the accelerations match the positions
+        */
+        GLboolean _AreAccelerationsValid = false;
+
+    private:
+        /**
+         * Advance the particles by a kick-drift-kick leapfrog step
+         * @param dt The duration of the step
+        */
+        void integrate(GLfloat dt);
+
+        /**
+         * Move the bodies driven by the particles to their positions
+        */
+        void moveBodies() const;
+
+        /**
+         * Get the longest step keeping the accuracy, from the current accelerations
+         * @return The duration of the step
+        */
+        GLdouble getAccurateStep() const;
+
+    public:
+        /**
+         * Add a particle
+         * @param position The particle's position
+         * @param velocity The particle's velocity
+         * @param mass The particle's mass
+         * @param body The body of the store moved with the particle, kInvalidBody for none
+         * @return The particle's index, valid until a particle is removed
+        */
+        GLuint add(const glm::dvec3& position, const glm::dvec3& velocity, GLfloat mass, BodyHandle body = kInvalidBody);
+
+        /**
+         * Remove the particle driving a body
+         * @param body The body's handle
+        */
+        void remove(BodyHandle body);
+
+        /**
+         * Set the gravitational constant
+         * @param gravitationalConstant The gravitational constant
+        */
+        void setGravitationalConstant(GLfloat gravitationalConstant){
+            _GravitationalConstant = gravitationalConstant;
+            _AreAccelerationsValid = false;
+        }
+
+        /**
+         * Set the Plummer softening length
+         * @param softening The softening length, positive
+        */
+        void setSoftening(GLfloat softening);
+
+        /**
+         * Set the Barnes-Hut opening angle, 0 computes every interaction
+         * @param openingAngle The opening angle
+        */
+        void setOpeningAngle(GLfloat openingAngle){
+            _OpeningAngle = openingAngle;
+            _AreAccelerationsValid = false;
+        }
+
+        /**
+         * Set the way of computing the forces
+         * @param solver The solver, GRAVITY_AUTO sums exactly under kDirectGravityLimit particles
+        */
+        void setSolver(GravitySolver solver){
+            _Solver = solver;
+            _AreAccelerationsValid = false;
+        }
+
+        /**
+         * Set the accuracy of the adaptive steps
+         * @param accuracy The fraction of sqrt(softening / largest acceleration) taken by a step, smaller is more accurate
+        */
+        void setStepAccuracy(GLfloat accuracy){
+            _StepAccuracy = accuracy > 0.0f ? accuracy : kDefaultStepAccuracy;
+        }
+
+        /**
+         * Compute the accelerations at the current positions
+        */
+        void computeAccelerations();
+
+        /**
+         * Advance the particles by a kick-drift-kick leapfrog step and move their bodies
+         * @param dt The duration of the step
+        */
+        void step(GLfloat dt);
+
+        /**
+         * Advance the particles by any duration in as many steps as the accuracy needs and move their bodies.
+         * When the steps don't fit in the time budget, fewer and longer steps are taken, up to kMaxStepStretch
+         * accurate steps: past that the rest of the duration is dropped and the particles fall behind
+         * @param duration The simulated duration
+         * @param budget The real time allowed, in seconds
+        */
+        void advance(GLdouble duration, GLdouble budget = kNoTimeBudget);
+
+        /**
+         * Tell if the last advance lost accuracy or fell behind to stay in its time budget
+         * @return True if the steps were longer than the accuracy asks for, or the duration wasn't all simulated
+        */
+        GLboolean isDegraded() const {
+            return _IsDegraded;
+        }
+
+        /**
+         * Get the simulated time the particles have fallen behind, the advances dropped to stay in their budgets
+         * @return The total time dropped
+        */
+        GLdouble getLag() const {
+            return _Lag;
+        }
+
+        /**
+         * Get the number of particles
+         * @return The number of particles
+        */
+        GLuint getNbParticles() const {
+            return _Masses.size();
+        }
+
+        /**
+         * Get the position of a particle
+         * @param particle The particle's index
+         * @return The position
+        */
+        glm::dvec3 getPosition(GLuint particle) const {
+            return glm::dvec3(_PositionsX[particle], _PositionsY[particle], _PositionsZ[particle]);
+        }
+
+        /**
+         * Get the velocity of a particle
+         * @param particle The particle's index
+         * @return The velocity
+        */
+        glm::dvec3 getVelocity(GLuint particle) const {
+            return glm::dvec3(_VelocitiesX[particle], _VelocitiesY[particle], _VelocitiesZ[particle]);
+        }
+
+        /**
+         * Get the mass of a particle
+         * @param particle The particle's index
+         * @return The mass
+        */
+        GLfloat getMass(GLuint particle) const {
+            return _Masses[particle];
+        }
+};
+
+#endif
@@ -0,0 +1,145 @@
+#ifndef __OCTREE_HPP__
+#define __OCTREE_HPP__
+
+#include <cstdint>
+#include <glad/gl.h>
+#include <vector>
+
+/**
+ * The maximal number of particles in a leaf, its forces are summed directly.
+ * Only the particles closer than the finest cells can share a larger leaf
+*/
+const static GLuint kOctreeLeafSize = 8;
+
+/**
+ * A node of the octree, stored depth first so that its children follow it
+*/
+struct OctreeNode{
+    /**
+     * The center of mass of the particles in the node
+    */
+    GLfloat _CenterX;
+    GLfloat _CenterY;
+    GLfloat _CenterZ;
+
+    /**
+     * The total mass of the particles in the node
+    */
+    GLfloat _Mass;
+
+    /**
+     * The edge length of the node's cube
+    */
+    GLfloat _Size;
+
+    /**
+     * The range of the node's particles, in the sorted order
+    */
+    GLuint _First;
+    GLuint _Last;
+
+    /**
+     * The index of the node following the node's subtree
+    */
+    GLuint _Next;
+
+    /**
+     * Tell if the node has no children
+    */
+    GLboolean _IsLeaf;
+};
+
+using OctreeNodes = std::vector<OctreeNode>;
+
+/**
+ * A Barnes-Hut octree approximating the gravity of far groups of particles by their center of mass.
+ * The particles are sorted along a Morton curve so that each node covers a contiguous range of them
+*/
+class Octree{
+    private:
+        /**
+         * The nodes, depth first, the root first
+        */
+        OctreeNodes _Nodes = {};
+
+        /**
+         * The original index of each sorted particle
+        */
+        std::vector<GLuint> _Order = {};
+
+        /**
+         * The Morton code of each sorted particle
+        */
+        std::vector<std::uint64_t> _Codes = {};
+
+        /**
+         * The sorted particles' positions and masses
+        */
+        std::vector<GLfloat> _X = {};
+        std::vector<GLfloat> _Y = {};
+        std::vector<GLfloat> _Z = {};
+        std::vector<GLfloat> _Masses = {};
+
+        /**
+         * The sorted particles' accelerations
+        */
+        std::vector<GLfloat> _AccelerationsX = {};
+        std::vector<GLfloat> _AccelerationsY = {};
+        std::vector<GLfloat> _AccelerationsZ = {};
+
+    private:
+        /**
+         * Sort a range of particles along the Morton curve of the cube bounding them
+         * @param first The first particle of the range
+         * @param last The particle after the last one of the range
+         * @return The edge length of the cube, 0 if the particles can't be told apart
+        */
+        GLfloat sortAlongCurve(GLuint first, GLuint last);
+
+        /**
+         * Create the node of a range of sorted particles and its subtree
+         * @param first The first particle of the node
+         * @param last The particle after the last one of the node
+         * @param level The node's depth in the cube of its Morton codes
+         * @param size The edge length of the node's cube
+        */
+        void buildNode(GLuint first, GLuint last, GLuint level, GLfloat size);
+
+    public:
+        /**
+         * Sort the particles and build the tree over them
+         * @param x, y, z The particles' positions
+         * @param masses The particles' masses
+         * @param nbParticles The number of particles
+        */
+        void build(const GLfloat* x, const GLfloat* y, const GLfloat* z, const GLfloat* masses, GLuint nbParticles);
+
+        /**
+         * Compute the gravitational acceleration of every particle in parallel
+         * @param gravitationalConstant The gravitational constant
+         * @param softening The Plummer softening length, avoiding the singularity of close encounters
+         * @param openingAngle The ratio size / distance under which a node is seen as a single mass
+         * @param ax, ay, az Set to the accelerations, in the particles' original order
+         * @cond The tree must have been built
+        */
+        void computeAccelerations(GLfloat gravitationalConstant, GLfloat softening, GLfloat openingAngle,
+                                    GLfloat* ax, GLfloat* ay, GLfloat* az);
+
+        /**
+         * Get the number of nodes
+         * @return The number of nodes
+        */
+        GLuint getNbNodes() const {
+            return _Nodes.size();
+        }
+
+        /**
+         * Get the nodes
+         * @return The nodes, depth first
+        */
+        const OctreeNodes& getNodes() const {
+            return _Nodes;
+        }
+};
+
+#endif
@@ -0,0 +1,85 @@
+#ifndef __ORBITAL_ELEMENTS_HPP__
+#define __ORBITAL_ELEMENTS_HPP__
+
+#include <cmath>
+#include <glad/gl.h>
+#include <glm/glm.hpp>
+
+/**
+ * The classical elements of a Kepler orbit, the angles in radians.
+ * The reference plane is the XZ plane and the prograde orbits turn counterclockwise seen from +Y,
+ * the reference direction of the ascending node is +X
+*/
+struct OrbitalElements{
+    /**
+     * The semi-major axis, in the orbit center's frame
+    */
+    GLfloat _SemiMajorAxis = 1.0f;
+
+    /**
+     * The eccentricity, in [0, 1)
+    */
+    GLfloat _Eccentricity = 0.0f;
+
+    /**
+     * The inclination of the orbit plane on the reference plane
+    */
+    GLfloat _Inclination = 0.0f;
+
+    /**
+     * The longitude of the ascending node
+    */
+    GLfloat _AscendingNode = 0.0f;
+
+    /**
+     * The argument of periapsis, from the ascending node
+    */
+    GLfloat _PeriapsisArgument = 0.0f;
+
+    /**
+     * The mean anomaly at the time zero
+    */
+    GLfloat _MeanAnomaly = 0.0f;
+
+    /**
+     * The mean motion, the mean angular speed 2pi / period
+    */
+    GLfloat _MeanMotion = 0.0f;
+
+    /**
+     * Get the direction of the periapsis
+     * @return The unit vector from the orbit center to the periapsis
+    */
+    glm::vec3 getPeriapsisDirection() const {
+        const GLfloat cosNode = std::cos(_AscendingNode), sinNode = std::sin(_AscendingNode);
+        const GLfloat cosArgument = std::cos(_PeriapsisArgument), sinArgument = std::sin(_PeriapsisArgument);
+        const GLfloat cosInclination = std::cos(_Inclination), sinInclination = std::sin(_Inclination);
+        // the ecliptic (x, y, z) with z up maps to (x, z, -y) with y up
+        return glm::vec3(cosArgument * cosNode - sinArgument * sinNode * cosInclination,
+                         sinArgument * sinInclination,
+                         -(cosArgument * sinNode + sinArgument * cosNode * cosInclination));
+    }
+
+    /**
+     * Get the direction 90 degrees ahead of the periapsis in the orbit plane
+     * @return The unit vector along the semi-minor axis, in the direction of the motion
+    */
+    glm::vec3 getSemiMinorDirection() const {
+        const GLfloat cosNode = std::cos(_AscendingNode), sinNode = std::sin(_AscendingNode);
+        const GLfloat cosArgument = std::cos(_PeriapsisArgument), sinArgument = std::sin(_PeriapsisArgument);
+        const GLfloat cosInclination = std::cos(_Inclination), sinInclination = std::sin(_Inclination);
+        return glm::vec3(-sinArgument * cosNode - cosArgument * sinNode * cosInclination,
+                         cosArgument * sinInclination,
+                         -(-sinArgument * sinNode + cosArgument * cosNode * cosInclination));
+    }
+
+    /**
+     * Get the semi-minor axis
+     * @return The semi-minor axis, in the orbit center's frame
+    */
+    GLfloat getSemiMinorAxis() const {
+        return _SemiMajorAxis * std::sqrt(1.0f - _Eccentricity * _Eccentricity);
+    }
+};
+
+#endif
@@ -1,15 +1,36 @@
 #ifndef __PLANET_HPP__
 #define __PLANET_HPP__
 
+#include "bodyStore.hpp"
 #include "entity.hpp"
+#include "ephemeris.hpp"
 #include "errorHandler.hpp"
+#include "lodChain.hpp"
 #include "mesh.hpp"
+#include "nBodySystem.hpp"
 #include <cstdio>
 #include <memory>
 
 class Planet;
 using PlanetPointer = std::shared_ptr<Planet>;
 
+/**
+ * The sphere levels of detail, by projected radius in pixels
+*/
+const static std::vector<SphereLod> kSphereLods = {
+    {4, 0.0f},
+    {8, 4.0f},
+    {16, 16.0f},
+    {32, 48.0f},
+    {64, 128.0f},
+    {128, 320.0f},
+};
+
+/**
+ * The level of detail used before the first selection, the former fixed resolution
+*/
+const static GLuint kDefaultSphereLod = 2;
+
 /**
  * A class to represent planets
 */
@@ -17,49 +38,44 @@ class Planet : public Entity{
 
     private:
         /**
-         * The planet's position
-        */
-        glm::vec3 _Position = glm::vec3(0.0f);
-
-        /**
-         * The common mesh for all planets
+         * The common sphere levels of detail for all planets, released with the last planet
         */
-        static MeshPointer _SphereMesh;
+        static std::weak_ptr<LodChain> _SphereLods;
 
         /**
-         * The planet it orbits around
+         * The sphere levels of detail, kept alive by the planets using them
         */
-        PlanetPointer _OrbitCenter = nullptr;
+        LodChainPointer _Lods = nullptr;
 
         /**
-         * The orbit speed
+         * The current level of detail
         */
-        GLfloat _OrbitSpeed = 0.0f;
+        GLuint _Lod = kDefaultSphereLod;
 
         /**
-         * The orbit radius
+         * The planet it orbits around
         */
-        GLfloat _OrbitRadius = 0.0f;
+        PlanetPointer _OrbitCenter = nullptr;
 
         /**
-         * The orbit axis
+         * The store holding the orbital state of all the planets
         */
-        glm::vec3 _OrbitAxis = glm::vec3(0.f,1.f,0.f);
+        BodyStorePointer _Store = nullptr;
 
         /**
-         * The rotation speed
+         * The planet's handle in the store
         */
-        GLfloat _RotationSpeed = 0.0f;
+        BodyHandle _Body = kInvalidBody;
 
         /**
-         * The rotation axis
+         * The gravity simulation moving the planet, nullptr if it follows an orbit
         */
-        glm::vec3 _RotationAxis = glm::vec3(0.f,1.f,0.f);
+        NBodySystemPointer _NBody = nullptr;
 
         /**
-         * The planet size
+         * The precomputed trajectories moving the planet, nullptr if it doesn't follow one
         */
-        GLfloat _Size = 1.0f;
+        EphemerisPointer _Ephemeris = nullptr;
 
         /**
          * Test if the object has been initialized
@@ -68,20 +84,15 @@ class Planet : public Entity{
 
     private:
         /**
-         * Get the static sphere mesh
+         * Get the static sphere levels of detail
         */
-        static MeshPointer getSphereMesh() {
-            if (_SphereMesh == nullptr) {
-                _SphereMesh = MeshPointer(new Mesh(Mesh::unitSphere()), &Planet::null_deleter);
+        static LodChainPointer getSphereLods() {
+            LodChainPointer lods = _SphereLods.lock();
+            if (lods == nullptr) {
+                lods = LodChain::spheres(SphereType::UV_SPHERE, kSphereLods);
+                _SphereLods = lods;
             }
-            return _SphereMesh;
-        }
-
-        /**
-         * A custom deleter for the static shared pointer
-        */
-        static void null_deleter(Mesh*){
-            // don't do anything
+            return lods;
         }
 
     public:
@@ -92,7 +103,49 @@ class Planet : public Entity{
         */
         Planet(const MaterialPointer& material, const ShadersPointer& shader)
             : Entity(material, shader){
-            _Mesh = MeshPointer(new Mesh(getSphereMesh()));
+            // share the spheres with the other planets, nothing is allocated per planet
+            _Lods = getSphereLods();
+            _Lod = std::min(kDefaultSphereLod, _Lods->getNbLevels()-1);
+            _Mesh = _Lods->getMesh(_Lod);
+
+            // the orbital state lives in the store, next to the other planets'
+            _Store = BodyStore::getInstance();
+            _Body = _Store->create();
+        }
+
+        /**
+         * A basic destructor
+        */
+        ~Planet(){
+            leaveNBody();
+            leaveEphemeris();
+            _Store->remove(_Body);
+        }
+
+        /**
+         * Get the mesh shared with other entities for instanced rendering
+         * @return The planet's mesh, sharing the sphere geometry
+        */
+        MeshPointer getInstancedMesh() const override {
+            return _Mesh;
+        }
+
+        /**
+         * Get the sphere bounding the planet, relative to the render origin
+         * @return The center (xyz) and radius (w) of the sphere
+        */
+        glm::vec4 getBoundingSphere() const override {
+            // the unit sphere is scaled by the whole chain of orbit centers
+            return glm::vec4(glm::vec3(_RenderModel[3]), glm::length(glm::vec3(_RenderModel[0])));
+        }
+
+        /**
+         * Select the sphere resolution from the planet's size on the screen
+         * @param projectedRadius The radius of the planet on the screen, in pixels
+        */
+        void selectLod(GLfloat projectedRadius) override {
+            _Lod = _Lods->select(projectedRadius, _Lod);
+            _Mesh = _Lods->getMesh(_Lod);
         }
 
         /**
@@ -102,12 +155,12 @@ class Planet : public Entity{
          * @param rotationAxis The rotation angle axis
          * @param position The planet's position
         */
-        void init(GLfloat size, GLfloat rotationSpeed, glm::vec3 rotationAxis, glm::vec3 position = glm::vec3(0.0f)){
-            _Size = size;
-            _RotationSpeed = rotationSpeed;
-            _RotationAxis = rotationAxis;
-            _Model = glm::scale(glm::translate(_Model, position), glm::vec3(size));
-            updatePosition();
+        void init(GLfloat size, GLfloat rotationSpeed, glm::vec3 rotationAxis, glm::dvec3 position = glm::dvec3(0.0)){
+            leaveNBody();
+            leaveEphemeris();
+            _OrbitCenter = nullptr;
+            _Store->setStill(_Body, size, rotationSpeed, rotationAxis, position);
+            _Model = _Store->getModel(_Body);
             _IsInitialized = true;
         }
 
@@ -124,58 +177,154 @@ class Planet : public Entity{
         void init(GLfloat size, GLfloat rotationSpeed, glm::vec3 rotationAxis, 
                     GLfloat orbitSpeed, glm::vec3 orbitAxis, GLfloat orbitRadius, 
                     const PlanetPointer& orbitCenter){
-            _Size = size;
-            _RotationSpeed = rotationSpeed;
-            _RotationAxis = rotationAxis;
-            _OrbitRadius = orbitRadius;
-            _OrbitSpeed = orbitSpeed;
+            leaveNBody();
+            leaveEphemeris();
+            _OrbitCenter = orbitCenter;
+            _Store->setOrbit(_Body, size, rotationSpeed, rotationAxis, orbitSpeed, orbitAxis, orbitRadius, orbitCenter->_Body);
+            _Model = _Store->getModel(_Body);
+            _IsInitialized = true;
+        }
+
+        /**
+         * Init a planet on a Kepler orbit
+         * @param size The planet's size relative to its parent size
+         * @param rotationSpeed The rotation's speed
+         * @param rotationAxis The rotation angle axis
+         * @param elements The orbital elements, in its orbit center's frame
+         * @param orbitCenter The center of the planet's orbit, at a focus of the ellipse
+        */
+        void init(GLfloat size, GLfloat rotationSpeed, glm::vec3 rotationAxis,
+                    const OrbitalElements& elements, const PlanetPointer& orbitCenter){
+            leaveNBody();
+            leaveEphemeris();
             _OrbitCenter = orbitCenter;
-            _OrbitAxis = orbitAxis;
-            _Model = glm::scale(glm::translate(glm::mat4(1.0f), _OrbitCenter->_Position + glm::vec3(orbitRadius, 0.0f, 0.0f)), glm::vec3(size));
-            updatePosition();
+            _Store->setKepler(_Body, size, rotationSpeed, rotationAxis, elements, orbitCenter->_Body);
+            _Model = _Store->getModel(_Body);
             _IsInitialized = true;
         }
 
         /**
-         * Update the planet
-         * @param dt The delta time
+         * Init a planet moved by the gravity of the other particles of a simulation
+         * @param size The planet's size
+         * @param rotationSpeed The rotation's speed
+         * @param rotationAxis The rotation angle axis
+         * @param position The planet's initial position
+         * @param velocity The planet's initial velocity
+         * @param mass The planet's mass
+         * @param system The gravity simulation, stepped by the scene
+         * @see Scene::setNBodySystem
+        */
+        void init(GLfloat size, GLfloat rotationSpeed, glm::vec3 rotationAxis,
+                    glm::dvec3 position, glm::dvec3 velocity, GLfloat mass, const NBodySystemPointer& system){
+            init(size, rotationSpeed, rotationAxis, position);
+            _NBody = system;
+            _NBody->add(position, velocity, mass, _Body);
+        }
+
+        /**
+         * Init a planet replaying a precomputed trajectory
+         * @param size The planet's size
+         * @param rotationSpeed The rotation's speed
+         * @param rotationAxis The rotation angle axis
+         * @param ephemeris The trajectories, evaluated by the scene
+         * @param record The planet's trajectory in the ephemeris
+         * @see Scene::setEphemeris
+        */
+        void init(GLfloat size, GLfloat rotationSpeed, glm::vec3 rotationAxis,
+                    const EphemerisPointer& ephemeris, GLuint record){
+            init(size, rotationSpeed, rotationAxis, ephemeris->getPosition(record, ephemeris->getTimeSpan(record).x));
+            _Ephemeris = ephemeris;
+            _Ephemeris->bind(record, _Body);
+        }
+
+        /**
+         * Update the planet alone, from its orbit center's current frame
+         * @param time The simulation time
          * @cond The planet must have been initialized
          * @see init
         */
-        void update(GLfloat dt) override {
-            if(!_IsInitialized){
-                fprintf(stderr, "The planet must be initialized properly before update! Call its `init` function!\n");
-                ErrorHandler::handle(ErrorCodes::NOT_INITALIZED);
-            }
-            // rotate arround itself
-            _Model = glm::scale(glm::mat4(1.0f), glm::vec3(_Size));
-            _Model = glm::rotate(_Model, _RotationSpeed*dt, _RotationAxis);
-
-            // orbit arround parent
-            if(_OrbitCenter != nullptr){
-                glm::vec3 orbitRadius = glm::vec3(_OrbitRadius, 0.0f, 0.0f);
-                // move the planet at the correct distance to the orbit center
-                glm::mat4 translation = glm::translate(glm::mat4(1.0f), orbitRadius);
-                // rotate the planet arround the orbit center
-                glm::mat4 rotation = glm::rotate(glm::mat4(1.0f), _OrbitSpeed*dt, _OrbitAxis);
-                // remove the tilt action of the parent
-                glm::mat4 tiltCorrection = glm::rotate(glm::mat4(1.0f), -_OrbitCenter->_RotationSpeed * dt, _OrbitCenter->_RotationAxis);
-                // apply the center's transformations to the planet
-                _Model = _OrbitCenter->getModel() * tiltCorrection * rotation * translation * _Model;
-            }
-            // update the position
-            updatePosition();
+        void update(GLdouble time) override {
+            checkInitialized();
+            _Store->update(_Body, time);
+            _Model = _Store->getModel(_Body);
+        }
+
+        /**
+         * Get the planet it orbits around
+         * @return The orbit center, or nullptr if the planet doesn't orbit
+        */
+        const Entity* getParent() const override {
+            return _OrbitCenter.get();
+        }
+
+        /**
+         * Tell if the planet's transform is computed by the body store
+         * @return True, the store sweeps every planet
+        */
+        GLboolean isInStore() const override {
+            return true;
+        }
+
+        /**
+         * Read the planet's model matrix from the store, only done for the orbit centers of entities out of the store
+         * @param time The simulation time
+         * @param parentFrame The orbit center's frame, already applied by the store
+         * @return The planet's frame, without its spin
+         * @cond The store must have been updated for this time
+         * @see BodyStore::update
+        */
+        glm::mat4 updateTransform(GLdouble time, const glm::mat4& parentFrame) override {
+            checkInitialized();
+            _Model = _Store->getModel(_Body);
+            return _Store->getFrame(_Body);
+        }
+
+        /**
+         * Use the model matrix interpolated by the store for the rendering
+         * @param alpha How far the rendered frame is from the previous step to the last one
+         * @param origin The render origin, usually the camera's position
+         * @cond The store must have been interpolated for the same origin
+         * @see BodyStore::interpolate
+        */
+        void interpolate(GLfloat alpha, const glm::dvec3& origin) override {
+            _RenderModel = _Store->getRenderModel(_Body);
+        }
+
+        /**
+         * Get the planet's position
+         * @return The position in double precision, in world space
+        */
+        const glm::dvec3& getPosition() const {
+            return _Store->getPosition(_Body);
         }
 
     private:
         /**
-         * Update the position
+         * Stop being moved by the gravity simulation
         */
-        void updatePosition(){
-            _Position = _Model*glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
-            //utils::displayVector3(_Position, stdout);
+        void leaveNBody(){
+            if(_NBody) _NBody->remove(_Body);
+            _NBody = nullptr;
+        }
+
+        /**
+         * Stop replaying the precomputed trajectory
+        */
+        void leaveEphemeris(){
+            if(_Ephemeris) _Ephemeris->unbind(_Body);
+            _Ephemeris = nullptr;
+        }
+
+        /**
+         * Stop if the planet has not been initialized
+        */
+        void checkInitialized() const {
+            if(!_IsInitialized){
+                fprintf(stderr, "The planet must be initialized properly before update! Call its `init` function!\n");
+                ErrorHandler::handle(ErrorCodes::NOT_INITALIZED);
+            }
         }
 
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -1,22 +1,35 @@
 #ifndef __SCENE_HPP__
 #define __SCENE_HPP__
 
+#include <cstddef>
 #include <glad/gl.h>
 #include <GLFW/glfw3.h>
 #include <memory>
 #include <string>
 #include <vector>
 
+#include "bodyStore.hpp"
 #include "entity.hpp"
 #include "camera.hpp"
+#include "catalogLoader.hpp"
+#include "ephemeris.hpp"
 #include "errorHandler.hpp"
+#include "frustum.hpp"
 #include "shaders.hpp"
 #include "light.hpp"
+#include "instancedRenderer.hpp"
+#include "nBodySystem.hpp"
+#include "sceneGraph.hpp"
+#include "uniformBlocks.hpp"
+#include "uniformBuffer.hpp"
 
 using Entities = std::vector<EntityPointer>;
 using PointLights = std::vector<LightPointer>;
 using DirectonalLights = std::vector<LightPointer>;
 
+using FrameBufferPointer = std::unique_ptr<UniformBuffer<FrameBlock>>;
+using LightsBufferPointer = std::unique_ptr<UniformBuffer<LightsBlock>>;
+
 class Scene;
 using ScenePointer = std::shared_ptr<Scene>;
 
@@ -54,7 +67,66 @@ class Scene{
          * The scene's camera
         */
         CameraPointer _Camera = nullptr;
-        
+
+        /**
+         * The per frame camera uniform buffer
+        */
+        FrameBufferPointer _FrameBuffer = nullptr;
+
+        /**
+         * The per frame lights uniform buffer
+        */
+        LightsBufferPointer _LightsBuffer = nullptr;
+
+        /**
+         * The renderer drawing the entities sharing a mesh
+        */
+        InstancedRendererPointer _Renderer = nullptr;
+
+        /**
+         * The CPU copy of the lights uniform block
+        */
+        LightsBlock _LightsBlock = {};
+
+        /**
+         * The bounding sphere of each entity, packed for the frustum test
+        */
+        BoundingSpheres _Bounds = {};
+
+        /**
+         * The result of the frustum test for each entity
+        */
+        Visibilities _Visible = {};
+
+        /**
+         * The entities' transform hierarchy, sorted parents first
+        */
+        SceneGraph _Graph;
+
+        /**
+         * Tell if the hierarchy must be flattened again
+        */
+        GLboolean _IsGraphDirty = true;
+
+        /**
+         * The optional gravity simulation, stepped before the orbits
+        */
+        NBodySystemPointer _NBody = nullptr;
+
+        /**
+         * The optional precomputed trajectories, evaluated before the orbits
+        */
+        EphemerisPointer _Ephemeris = nullptr;
+
+        /**
+         * The catalog whose bodies are being added, released once they all are
+        */
+        CatalogLoaderPointer _Catalog = nullptr;
+
+        /**
+         * The simulation time of the last update
+        */
+        GLdouble _LastUpdateTime = 0.0;
 
     public:
         /**
@@ -66,7 +138,7 @@ class Scene{
         }
 
         /**
-         * Add an entity to the scene
+         * Add an entity to the scene, initialized at once if the scene already is
          * @param entity The entity to add
         */
         void addElement(const EntityPointer& entity){
@@ -75,7 +147,20 @@ class Scene{
                 ErrorHandler::handle(ErrorCodes::NOT_INITALIZED, ErrorLevel::WARNING);
                 return;
             }
+            if(_Renderer) entity->init();
             _Entities.push_back(entity);
+            // the graph only keeps the bodies of the store that other entities hang from
+            if(!entity->isInStore() || _Graph.isMissingParents()) _IsGraphDirty = true;
+        }
+
+        /**
+         * Add a set of entities to the scene, initialized at once if the scene already is
+         * @param entities The entities to add
+        */
+        void addElements(const Entities& entities){
+            for(const EntityPointer& entity : entities){
+                addElement(entity);
+            }
         }
 
         /**
@@ -88,6 +173,11 @@ class Scene{
                 ErrorHandler::handle(ErrorCodes::WRONG_TYPE, ErrorLevel::WARNING);
                 return;
             }
+            if(_NbPointLights >= kMaxLights){
+                fprintf(stderr, "Can't have more than %d point lights in the scene!", kMaxLights);
+                ErrorHandler::handle(ErrorCodes::OUT_OF_RANGE, ErrorLevel::WARNING);
+                return;
+            }
             _PointLights.push_back(light);
             _NbPointLights++;
         }
@@ -102,6 +192,11 @@ class Scene{
                 ErrorHandler::handle(ErrorCodes::WRONG_TYPE, ErrorLevel::WARNING);
                 return;
             }
+            if(_NbDirectionalLights >= kMaxLights){
+                fprintf(stderr, "Can't have more than %d directional lights in the scene!", kMaxLights);
+                ErrorHandler::handle(ErrorCodes::OUT_OF_RANGE, ErrorLevel::WARNING);
+                return;
+            }
             _DirectionalLights.push_back(light);
             _NbDirectionalLights++;
         }
@@ -128,62 +223,142 @@ class Scene{
         }
 
         /**
-         * Initiate all the entities
+         * Move particles under their mutual gravity at each update
+         * @param system The gravity simulation, nullptr to disable it
         */
-        void initMeshes() const {
+        void setNBodySystem(const NBodySystemPointer& system){
+            _NBody = system;
+        }
+
+        /**
+         * Get the gravity simulation
+         * @return The gravity simulation, nullptr if there is none
+        */
+        const NBodySystemPointer& getNBodySystem() const {
+            return _NBody;
+        }
+
+        /**
+         * Replay precomputed trajectories at each update
+         * @param ephemeris The trajectories, nullptr to disable them
+        */
+        void setEphemeris(const EphemerisPointer& ephemeris){
+            _Ephemeris = ephemeris;
+        }
+
+        /**
+         * Get the precomputed trajectories
+         * @return The ephemeris, nullptr if there is none
+        */
+        const EphemerisPointer& getEphemeris() const {
+            return _Ephemeris;
+        }
+
+        /**
+         * Add the bodies of a catalog as it is read in the background
+         * @param catalog The catalog, nullptr to stop adding its bodies
+         * @see ingest
+        */
+        void setCatalog(const CatalogLoaderPointer& catalog){
+            _Catalog = catalog;
+        }
+
+        /**
+         * Add the catalog's bodies read since the last frame
+         * @param budget The real time allowed, in seconds
+        */
+        void ingest(GLdouble budget){
+            if(_Catalog && !_Catalog->addBodies(*this, budget)) _Catalog = nullptr;
+        }
+
+        /**
+         * Initiate all the entities and the per frame uniform buffers
+        */
+        void initMeshes() {
+            _FrameBuffer = FrameBufferPointer(new UniformBuffer<FrameBlock>(UniformBinding::FRAME_BINDING));
+            _LightsBuffer = LightsBufferPointer(new UniformBuffer<LightsBlock>(UniformBinding::LIGHTS_BINDING));
+            _Renderer = InstancedRendererPointer(new InstancedRenderer());
             for(auto entity : _Entities){
                 entity->init();
             }
         }
 
         /**
-         * Update the entities
-         * @param dt The delta time
+         * Run a simulation step, each orbit center before its satellites.
+         * The orbits are solved at the given time whatever the step's duration, the gravity simulation takes sub-steps
+         * @param time The simulation time
+         * @param budget The real time allowed to the gravity simulation, in seconds
         */
-        void update(GLfloat dt) const {
+        void update(GLdouble time, GLdouble budget = kNoTimeBudget) {
+            if(_IsGraphDirty){
+                _Graph.build(_Entities);
+                _IsGraphDirty = false;
+            }
+            // the particles and the trajectories move their bodies, the orbits are swept in the store, the graph then updates the entities out of it
+            if(_NBody && time > _LastUpdateTime) _NBody->advance(time - _LastUpdateTime, budget);
+            if(_Ephemeris) _Ephemeris->moveBodies(time);
+            _LastUpdateTime = time;
+            BodyStore::getInstance()->update(time);
+            _Graph.update(time);
+        }
+
+        /**
+         * Place the entities between the last two simulation steps before rendering
+         * @param alpha How far the rendered frame is from the previous step to the last one
+        */
+        void interpolate(GLfloat alpha) {
+            // the entities are rendered relative to the camera, far from the world's origin the floats stay accurate
+            const glm::dvec3 origin = _Camera->getPosition();
+            BodyStore::getInstance()->interpolate(alpha, origin);
             for(auto entity : _Entities){
-                entity->update(dt);
+                entity->interpolate(alpha, origin);
             }
         }
 
         /**
          * Render all the meshes
-         * @cond All the entities must have shaders with "viewMat", "projMat" and "camPos" uniform variables
-         * @cond Shaders must have the correct light uniform variables
-        */
-        void render() const {
-            // get the coordinate matrices
-            const glm::mat4 view  = _Camera->getViewMatrix();
-            const glm::mat4 proj  = _Camera->getProjectionMatrix(ProjectionType::PERSP);
-            
-            // render the enetities
-            for(auto entity : _Entities){
-                ShadersPointer shader = entity->getShader();
-                shader->use();
-
-                // set the matrices
-                shader->setMat4f("viewMat", view);
-                shader->setMat4f("projMat", proj);
-                shader->setVec3f("camPos", _Camera->getPosition());
-
-                // set the point lights
-                shader->setInt("NB_POINT_LIGHTS", _NbPointLights);
-                for(GLuint i=0; i<_NbPointLights; i++){
-                    std::string name = "pointLights[" + std::to_string(i) + "]";
-                    _PointLights[i]->sendGPU(shader, name);
-                }
+         * @cond All the entities must have shaders using the "FrameData" and "Lights" uniform blocks
+         * @see uniformBlocks.hpp
+        */
+        void render() {
+            if(!_FrameBuffer || !_LightsBuffer || !_Renderer){
+                fprintf(stderr, "The scene must be initialized before rendering! Call its `initMeshes` function!\n");
+                ErrorHandler::handle(ErrorCodes::NOT_INITALIZED);
+            }
 
-                // set the directional lights
-                shader->setInt("NB_DIRECTIONAL_LIGHTS", _NbDirectionalLights);
-                for(GLuint i=0; i<_NbDirectionalLights; i++){
-                    std::string name = "directionalLights[" + std::to_string(i) + "]";
-                    _DirectionalLights[i]->sendGPU(shader, name);
-                }
+            // upload the camera once per frame
+            FrameBlock frame;
+            frame._ViewMat = _Camera->getViewMatrix();
+            frame._ProjMat = _Camera->getProjectionMatrix(ProjectionType::PERSP);
+            frame._CamPos  = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+            _FrameBuffer->update(frame);
 
-                entity->render();
-            }
+            // upload the lights once per frame
+            updateLights();
 
+            // skip the entities outside of the camera's view
+            _Bounds.resize(_Entities.size());
+            for(size_t i=0; i<_Entities.size(); i++){
+                _Bounds[i] = _Entities[i]->getBoundingSphere();
+            }
+            Frustum(frame._ProjMat * frame._ViewMat).cull(_Bounds, _Visible);
 
+            // render the enetities, batching the ones sharing a mesh
+            for(size_t i=0; i<_Entities.size(); i++){
+                if(!_Visible[i]) continue;
+                const EntityPointer& entity = _Entities[i];
+                const glm::vec4& bounds = _Bounds[i];
+                if(bounds.w > 0.0f){
+                    entity->selectLod(_Camera->getProjectedRadius(glm::vec3(bounds), bounds.w));
+                }
+                MeshPointer sharedMesh = entity->getInstancedMesh();
+                if(sharedMesh){
+                    _Renderer->submit(sharedMesh, entity->getShader(), entity->getTexture(), entity->getSampler(), entity->getInstanceData());
+                } else {
+                    entity->render();
+                }
+            }
+            _Renderer->flush();
         }
 
         /**
@@ -193,6 +368,24 @@ class Scene{
         const CameraPointer getCamera() const {
             return _Camera;
         }
+
+    private:
+        /**
+         * Fill the lights uniform block and upload the used lights
+        */
+        void updateLights() {
+            _LightsBlock._NbLights = glm::ivec4(_NbPointLights, _NbDirectionalLights, 0, 0);
+            for(GLuint i=0; i<_NbPointLights; i++){
+                _LightsBlock._PointLights[i] = _PointLights[i]->getData();
+            }
+            for(GLuint i=0; i<_NbDirectionalLights; i++){
+                _LightsBlock._DirectionalLights[i] = _DirectionalLights[i]->getData();
+            }
+
+            _LightsBuffer->updateRange(_LightsBlock, offsetof(LightsBlock, _NbLights), sizeof(glm::ivec4));
+            _LightsBuffer->updateRange(_LightsBlock, offsetof(LightsBlock, _PointLights), _NbPointLights*sizeof(LightData));
+            _LightsBuffer->updateRange(_LightsBlock, offsetof(LightsBlock, _DirectionalLights), _NbDirectionalLights*sizeof(LightData));
+        }
 };
 
 #endif
\ No newline at end of file
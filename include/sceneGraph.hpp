@@ -0,0 +1,127 @@
+#ifndef __SCENE_GRAPH_HPP__
+#define __SCENE_GRAPH_HPP__
+
+#include <glad/gl.h>
+#include <glm/glm.hpp>
+#include <vector>
+
+class Entity;
+
+using GraphNodes = std::vector<Entity*>;
+using GraphParents = std::vector<GLint>;
+using GraphFrames = std::vector<glm::mat4>;
+using GraphLevels = std::vector<GLuint>;
+
+/**
+ * A flattened transform hierarchy: the entities are stored sorted by depth,
+ * with the index of their parent, so that a single linear sweep updates every parent before its children.
+ * The bodies of the store are already swept by it, they are only kept as the parents of the other entities
+*/
+class SceneGraph{
+    private:
+        /**
+         * The entities, sorted by depth
+        */
+        GraphNodes _Nodes = {};
+
+        /**
+         * The index of each node's parent, -1 for the roots
+        */
+        GraphParents _Parents = {};
+
+        /**
+         * The frame of each node, given to its children
+        */
+        GraphFrames _Frames = {};
+
+        /**
+         * The index of the first node of each depth, plus the number of nodes at the end
+        */
+        GraphLevels _Levels = {};
+
+        /**
+         * Tell if an entity's parent wasn't given at the last build
+        */
+        GLboolean _IsMissingParents = false;
+
+    public:
+        /**
+         * Flatten the hierarchy of a set of entities
+         * @param entities The entities, in any order
+        */
+        template <typename EntityPointers>
+        void build(const EntityPointers& entities){
+            GraphNodes nodes;
+            nodes.reserve(entities.size());
+            for(const auto& entity : entities){
+                nodes.push_back(entity.get());
+            }
+            build(nodes);
+        }
+
+        /**
+         * Flatten the hierarchy of a set of entities, leaving out the bodies of the store without other entities below
+         * @param allEntities The entities, in any order
+        */
+        void build(const GraphNodes& allEntities);
+
+        /**
+         * Update the transform of every entity, parents first.
+         * The entities of the same depth are updated in parallel
+         * @param time The simulation time
+        */
+        void update(GLdouble time);
+
+        /**
+         * Get the number of nodes
+         * @return The number of nodes
+        */
+        GLuint getNbNodes() const {
+            return _Nodes.size();
+        }
+
+        /**
+         * Get the number of depth levels
+         * @return The number of depth levels
+        */
+        GLuint getNbLevels() const {
+            return _Levels.empty() ? 0 : _Levels.size()-1;
+        }
+
+        /**
+         * Tell if an entity's parent wasn't given at the last build, the hierarchy then changes once it is
+         * @return True if an entity was updated as a root for lack of its parent
+        */
+        GLboolean isMissingParents() const {
+            return _IsMissingParents;
+        }
+
+        /**
+         * Get the nodes
+         * @return The entities, sorted by depth
+        */
+        const GraphNodes& getNodes() const {
+            return _Nodes;
+        }
+
+        /**
+         * Get the parent indices
+         * @return The index of each node's parent, -1 for the roots
+        */
+        const GraphParents& getParents() const {
+            return _Parents;
+        }
+
+        /**
+         * Get the range of the nodes of a depth level
+         * @param level The depth level
+         * @param first Set to the index of the first node of the level
+         * @param last Set to the index after the last node of the level
+        */
+        void getLevel(GLuint level, GLuint& first, GLuint& last) const {
+            first = _Levels[level];
+            last = _Levels[level+1];
+        }
+};
+
+#endif
@@ -0,0 +1,255 @@
+#ifndef __SCENE_LOADER_HPP__
+#define __SCENE_LOADER_HPP__
+
+#include <glad/gl.h>
+#include <glm/glm.hpp>
+#include <string>
+#include <unordered_map>
+
+#include "camera.hpp"
+#include "jsonReader.hpp"
+#include "material.hpp"
+#include "orbitalElements.hpp"
+#include "planet.hpp"
+#include "scene.hpp"
+#include "shaders.hpp"
+
+/**
+ * The description of a body, filled from its JSON object before the body is created
+*/
+struct BodyDescription{
+    /**
+     * The name the satellites refer to, empty for an anonymous body
+    */
+    std::string _Name = "";
+
+    /**
+     * Tell if the body is a sun, lighting the scene
+    */
+    GLboolean _IsSun = false;
+
+    /**
+     * The look: the material's name, the color and the texture's path
+    */
+    std::string _Material = "";
+    glm::vec4 _Color = glm::vec4(1.0f);
+    std::string _Texture = "";
+
+    /**
+     * The size and the spin
+    */
+    GLfloat _Size = 1.0f;
+    GLfloat _RotationSpeed = 0.0f;
+    glm::vec3 _RotationAxis = glm::vec3(0.0f, 1.0f, 0.0f);
+
+    /**
+     * The position of a body without an orbit
+    */
+    glm::dvec3 _Position = glm::dvec3(0.0);
+
+    /**
+     * The orbit center's name, empty for the bodies without an orbit
+    */
+    std::string _OrbitCenter = "";
+
+    /**
+     * The circular orbit
+    */
+    GLfloat _OrbitSpeed = 0.0f;
+    glm::vec3 _OrbitAxis = glm::vec3(0.0f, 1.0f, 0.0f);
+    GLfloat _OrbitRadius = 0.0f;
+
+    /**
+     * The Kepler orbit, used instead of the circular one when set
+    */
+    GLboolean _IsKepler = false;
+    OrbitalElements _Elements = {};
+
+    /**
+     * The sun's light, relative to the sun
+    */
+    glm::vec3 _LightPosition = glm::vec3(0.0f);
+    glm::vec3 _LightColor = glm::vec3(1.0f);
+};
+
+/**
+ * A loader of the scene files, JSON descriptions of the camera, the materials and the bodies:
+ * @code
+ * {
+ *     "camera": {"position": [0, 5, 25], "target": [0, 0, 0]},
+ *     "materials": {"rock": {"ambient": 0.1, "diffuse": 1, "specular": 0.5, "shininess": 10}},
+ *     "bodies": [
+ *         {"name": "sun", "type": "sun", "material": "rock", "size": 1, "light": {"color": [1, 1, 1]}},
+ *         {"name": "earth", "material": "rock", "texture": "media/earth.jpg", "size": 0.5, "rotationSpeed": 0.05,
+ *          "orbit": {"center": "sun", "speed": 1, "axis": [0, 1, 0], "radius": 10}},
+ *         {"material": "rock", "size": 0.01,
+ *          "kepler": {"center": "sun", "semiMajorAxis": 30, "eccentricity": 0.2, "meanMotion": 0.05}}
+ *     ],
+ *     "ephemeris": {"file": "media/asteroids.eph", "material": "rock", "size": 0.05},
+ *     "catalog": {"file": "media/stars.txt", "material": "rock", "color": [1, 1, 0.9, 1]}
+ * }
+ * @endcode
+ * The file is parsed as a stream, each body is created as soon as its object ends: an orbit center must come before
+ * its satellites. Only the named bodies are remembered. The orbits are checked when their body ends, a Kepler orbit
+ * needs a mean motion. The catalog's bodies are added while the scene runs
+ * @see CatalogLoader
+*/
+class SceneLoader{
+    private:
+        /**
+         * The text being parsed
+        */
+        JsonReader _Reader;
+
+        /**
+         * The file's path, for the messages
+        */
+        std::string _FileName = "";
+
+        /**
+         * The scene being filled
+        */
+        ScenePointer _Scene = nullptr;
+
+        /**
+         * The shader of every body
+        */
+        ShadersPointer _Shader = nullptr;
+
+        /**
+         * The materials, by name
+        */
+        std::unordered_map<std::string, MaterialPointer> _Materials = {};
+
+        /**
+         * The named bodies, by name
+        */
+        std::unordered_map<std::string, PlanetPointer> _Bodies = {};
+
+    private:
+        /**
+         * A loader of a file
+         * @param fileName The file's path
+         * @param shader The shader of every body
+        */
+        SceneLoader(const std::string& fileName, const ShadersPointer& shader)
+            : _FileName(fileName), _Shader(shader){}
+
+        /**
+         * Print a parsing error at the current line
+         * @param message The error's description
+         * @return False, to be returned by the parsing functions
+        */
+        GLboolean fail(const char* message);
+
+        /**
+         * Read an object, calling a function on each of its keys
+         * @param readValue The function reading the value of the current key, false on errors
+         * @return False if the text is malformed
+        */
+        template <typename ReadValue>
+        GLboolean readObject(ReadValue readValue);
+
+        /**
+         * Read the keys of an object already opened, calling a function on each of them
+         * @param readValue The function reading the value of the current key, false on errors
+         * @return False if the text is malformed
+        */
+        template <typename ReadValue>
+        GLboolean readMembers(ReadValue readValue);
+
+        /**
+         * Read a number
+         * @param value Set to the number
+         * @return False if the value isn't a number
+        */
+        GLboolean readNumber(GLfloat& value);
+        GLboolean readNumber(GLdouble& value);
+
+        /**
+         * Read a string
+         * @param value Set to the string
+         * @return False if the value isn't a string
+        */
+        GLboolean readString(std::string& value);
+
+        /**
+         * Read an array of numbers
+         * @param values Set to the numbers
+         * @param size The number of numbers
+         * @return False if the value isn't an array of this size
+        */
+        GLboolean readNumbers(GLdouble* values, GLuint size);
+
+        /**
+         * Read a vector
+         * @param value Set to the vector
+         * @return False if the value isn't an array of the vector's size
+        */
+        GLboolean readVector(glm::vec3& value);
+        GLboolean readVector(glm::dvec3& value);
+        GLboolean readVector(glm::vec4& value);
+
+        /**
+         * Read the camera
+         * @param camera The camera to place
+         * @return False if the text is malformed
+        */
+        GLboolean readCamera(const CameraPointer& camera);
+
+        /**
+         * Read the materials
+         * @return False if the text is malformed
+        */
+        GLboolean readMaterials();
+
+        /**
+         * Read the bodies, creating each one after its object
+         * @return False if the text is malformed
+        */
+        GLboolean readBodies();
+
+        /**
+         * Read a body whose object has been opened
+         * @param body Filled with the body's description
+         * @return False if the text is malformed or the body can't be simulated
+        */
+        GLboolean readBody(BodyDescription& body);
+
+        /**
+         * Read an ephemeris and create a body for each of its trajectories
+         * @return False if the text is malformed
+        */
+        GLboolean readEphemeris();
+
+        /**
+         * Read a catalog and start adding its bodies in the background
+         * @return False if the text is malformed
+        */
+        GLboolean readCatalog();
+
+        /**
+         * Get a material by name
+         * @param name The material's name, empty for the default material
+         * @return The material, the default one if the name is unknown
+        */
+        MaterialPointer getMaterial(const std::string& name);
+
+        /**
+         * Create a body and add it to the scene
+         * @param body The body's description
+        */
+        void createBody(const BodyDescription& body);
+
+    public:
+        /**
+         * Load a scene file
+         * @param fileName The file's path
+         * @param camera The scene's camera, placed by the file
+         * @param shader The shader of every body
+         * @return The scene, nullptr if the file can't be read or is malformed
+        */
+        static ScenePointer load(const std::string& fileName, CameraPointer& camera, const ShadersPointer& shader);
+};
+
+#endif
@@ -7,8 +7,10 @@
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <unordered_map>
 
 #include "errorHandler.hpp"
+#include "uniformBlocks.hpp"
 
 #include <glm/glm.hpp>
 #include <glm/ext.hpp>
@@ -21,6 +23,23 @@ using ShadersPointer = std::shared_ptr<Shaders>;
 */
 enum ShaderType{VERT, FRAG, GEOM};
 
+/**
+ * A uniform variable resolved once inside a program
+*/
+struct UniformHandle{
+    /**
+     * The uniform's location (-1 if not active)
+    */
+    GLint _Location = -1;
+
+    /**
+     * The uniform's GLSL type
+    */
+    GLenum _Type = GL_NONE;
+};
+
+using Uniforms = std::unordered_map<std::string, UniformHandle>;
+
 class Shaders{
 
     private:
@@ -29,6 +48,16 @@ class Shaders{
         */
         GLuint _Id = -1;
 
+        /**
+         * The program currently bound to the context
+        */
+        static GLuint _CurrentId;
+
+        /**
+         * The uniform locations, filled once after linking
+        */
+        mutable Uniforms _Uniforms = {};
+
     public:
         /**
          * Basic constructor
@@ -42,6 +71,7 @@ class Shaders{
          * Basic destructor
         */
         ~Shaders(){
+            if(_CurrentId == _Id) _CurrentId = 0;
             glDeleteProgram(_Id);
         }
 
@@ -58,16 +88,94 @@ class Shaders{
         */
         void use() const;
 
+        /**
+         * Resolve a uniform variable once
+         * @param name The variable's name
+         * @return The handle to give to the setters (invalid if the uniform is not active)
+        */
+        UniformHandle getUniform(const std::string& name) const {
+            auto it = _Uniforms.find(name);
+            if(it != _Uniforms.end()) return it->second;
+            // not an active uniform, remember it to avoid asking the driver again
+            checkID("Can't get a uniform location before creating the program!\n");
+            UniformHandle handle = {glGetUniformLocation(_Id, name.c_str()), GL_NONE};
+            _Uniforms[name] = handle;
+            return handle;
+        }
+
+        /**
+         * Set a uniform boolean
+         * @param uniform The variable's handle
+         * @param val The variable's value
+        */
+        void setBool(const UniformHandle& uniform, bool val) const {
+            use();
+            glUniform1i(uniform._Location, (GLint)val);
+            checkGL(uniform);
+        }
+
+        /**
+         * Set a uniform int
+         * @param uniform The variable's handle
+         * @param val The variable's value
+        */
+        void setInt(const UniformHandle& uniform, int val) const {
+            use();
+            glUniform1i(uniform._Location, (GLint)val);
+            checkGL(uniform);
+        }
+
+        /**
+         * Set a uniform float
+         * @param uniform The variable's handle
+         * @param val The variable's value
+        */
+        void setFloat(const UniformHandle& uniform, float val) const {
+            use();
+            glUniform1f(uniform._Location, val);
+            checkGL(uniform);
+        }
+
+        /**
+         * Set a uniform 4x4 float matrix
+         * @param uniform The variable's handle
+         * @param val The variable's value
+        */
+        void setMat4f(const UniformHandle& uniform, const glm::mat4x4& val) const {
+            use();
+            glUniformMatrix4fv(uniform._Location, 1, GL_FALSE, glm::value_ptr(val));
+            checkGL(uniform);
+        }
+
+        /**
+         * Set a uniform 3x1 float vector
+         * @param uniform The variable's handle
+         * @param val The variable's value
+        */
+        void setVec3f(const UniformHandle& uniform, const glm::vec3& val) const {
+            use();
+            glUniform3fv(uniform._Location, 1, glm::value_ptr(val));
+            checkGL(uniform);
+        }
+
+        /**
+         * Set a uniform 4x1 float vector
+         * @param uniform The variable's handle
+         * @param val The variable's value
+        */
+        void setVec4f(const UniformHandle& uniform, const glm::vec4& val) const {
+            use();
+            glUniform4fv(uniform._Location, 1, glm::value_ptr(val));
+            checkGL(uniform);
+        }
+
         /**
          * Set a uniform boolean
          * @param name The variable's name
          * @param val The variable's value
         */
         void setBool(const std::string& name, bool val) const {
-            use();
-            checkID("Can't set a uniform value before creating the program!\n");
-            glUniform1i(glGetUniformLocation(_Id, name.c_str()), (GLuint)val);
-            ErrorHandler::handleGL("Failed to set %s!\n", name.c_str());
+            setBool(getUniform(name), val);
         }
 
         /**
@@ -76,10 +184,7 @@ class Shaders{
          * @param val The variable's value
         */
         void setInt(const std::string& name, int val) const {
-            use();
-            checkID("Can't set a uniform value before creating the program!\n");
-            glUniform1i(glGetUniformLocation(_Id, name.c_str()), (GLuint)val);
-            ErrorHandler::handleGL("Failed to set %s!\n", name.c_str());
+            setInt(getUniform(name), val);
         }
 
         /**
@@ -88,10 +193,7 @@ class Shaders{
          * @param val The variable's value
         */
         void setFloat(const std::string& name, float val) const {
-            use();
-            checkID("Can't set a uniform value before creating the program!\n");
-            glUniform1f(glGetUniformLocation(_Id, name.c_str()), (GLuint)val);
-            ErrorHandler::handleGL("Failed to set %s!\n", name.c_str());
+            setFloat(getUniform(name), val);
         }
 
         /**
@@ -100,10 +202,7 @@ class Shaders{
          * @param val The variable's value
         */
         void setMat4f(const std::string& name, const glm::mat4x4& val) const {
-            use();
-            checkID("Can't set a uniform value before creating the program!\n");
-            glUniformMatrix4fv(glGetUniformLocation(_Id, name.c_str()), 1, GL_FALSE, glm::value_ptr(val));
-            ErrorHandler::handleGL("Failed to set %s!\n", name.c_str());
+            setMat4f(getUniform(name), val);
         }
 
         /**
@@ -112,10 +211,7 @@ class Shaders{
          * @param val The variable's value
         */
         void setVec3f(const std::string& name, const glm::vec3& val) const {
-            use();
-            checkID("Can't set a uniform value before creating the program!\n");
-            glUniform3fv(glGetUniformLocation(_Id, name.c_str()), 1, glm::value_ptr(val));
-            ErrorHandler::handleGL("Failed to set %s!\n", name.c_str());
+            setVec3f(getUniform(name), val);
         }
 
         /**
@@ -124,10 +220,7 @@ class Shaders{
          * @param val The variable's value
         */
         void setVec4f(const std::string& name, const glm::vec4& val) const {
-            use();
-            checkID("Can't set a uniform value before creating the program!\n");
-            glUniform4fv(glGetUniformLocation(_Id, name.c_str()), 1, glm::value_ptr(val));
-            ErrorHandler::handleGL("Failed to set %s!\n", name.c_str());
+            setVec4f(getUniform(name), val);
         }
 
     private:
@@ -155,6 +248,23 @@ class Shaders{
         */
         void linkShaders(GLuint vert, GLuint frag, GLuint geom = -1);
 
+        /**
+         * Fill the uniform table with all the active uniforms of the program
+        */
+        void introspectUniforms();
+
+        /**
+         * Attach a uniform block of the program to a binding point
+         * @param name The block's name
+         * @param binding The binding point
+         * @cond Does nothing if the program does not use the block
+        */
+        void bindUniformBlock(const std::string& name, GLuint binding) const {
+            GLuint index = glGetUniformBlockIndex(_Id, name.c_str());
+            if(index == GL_INVALID_INDEX) return;
+            glUniformBlockBinding(_Id, index, binding);
+        }
+
         /**
          * Delete the given shader
          * @param shader The vertex shader
@@ -174,6 +284,16 @@ class Shaders{
             }
         }
 
+        /**
+         * Check the last uniform upload (only in debug builds)
+         * @param uniform The uniform that was set
+        */
+        void checkGL(const UniformHandle& uniform) const {
+        #ifndef NDEBUG
+            ErrorHandler::handleGL("Failed to set the uniform at location %d!\n", uniform._Location);
+        #endif
+        }
+
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,131 @@
+#ifndef __SIMD_LANES_HPP__
+#define __SIMD_LANES_HPP__
+
+/**
+ * The lane types the batched kernels are written against: one struct per instruction set
+ * with the same static operations, so that a kernel template is compiled once for each of them.
+ * Only included by the kernels' translation units: everything lives in an anonymous namespace
+ * so that the code compiled for a wider instruction set never replaces the portable one at link time.
+ * The translation units are compiled for the baseline instruction set, only the functions marked with
+ * SIMD_AVX2_TARGET use AVX2 and FMA: the library's inline functions they call stay portable wherever they are emitted
+*/
+
+#include <cmath>
+#include <glad/gl.h>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define SIMD_LANES_SSE
+#endif
+
+#if defined(__AVX2__) && defined(__FMA__)
+#include <immintrin.h>
+#define SIMD_LANES_AVX2
+#define SIMD_AVX2_TARGET
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define SIMD_LANES_AVX2
+#define SIMD_AVX2_TARGET __attribute__((target("avx2,fma")))
+#elif defined(_MSC_VER) && defined(_M_X64)
+// the intrinsics are always available, only the code using them needs the instructions
+#include <immintrin.h>
+#define SIMD_LANES_AVX2
+#define SIMD_AVX2_TARGET
+#else
+// no AVX2 lanes, the kernels marked for them are compiled for the baseline and never called
+#define SIMD_AVX2_TARGET
+#endif
+
+/**
+ * The instruction set of the kernels' functions, defined by a translation unit before the kernel's body
+*/
+#ifndef SIMD_KERNEL_TARGET
+#define SIMD_KERNEL_TARGET
+#endif
+
+namespace {
+
+/**
+ * One float per lane, the portable fallback and the tail of the wider instruction sets
+*/
+struct ScalarLanes{
+    using F = GLfloat;
+    static const int Width = 1;
+    static F set1(GLfloat a) { return a; }
+    static F load(const GLfloat* a) { return *a; }
+    static void store(GLfloat* a, F b) { *a = b; }
+    static F add(F a, F b) { return a + b; }
+    static F sub(F a, F b) { return a - b; }
+    static F mul(F a, F b) { return a * b; }
+    static F div(F a, F b) { return a / b; }
+    static F fmadd(F a, F b, F c) { return a * b + c; }
+    static F floor(F a) { return std::floor(a); }
+    static F copySign(F a, F b) { return std::copysign(a, b); }
+    static F rsqrt(F a) { return 1.0f / std::sqrt(a); }
+};
+
+#ifdef SIMD_LANES_SSE
+/**
+ * Four floats per lane, always available on x86-64
+*/
+struct SseLanes{
+    using F = __m128;
+    static const int Width = 4;
+    static F set1(GLfloat a) { return _mm_set1_ps(a); }
+    static F load(const GLfloat* a) { return _mm_loadu_ps(a); }
+    static void store(GLfloat* a, F b) { _mm_storeu_ps(a, b); }
+    static F add(F a, F b) { return _mm_add_ps(a, b); }
+    static F sub(F a, F b) { return _mm_sub_ps(a, b); }
+    static F mul(F a, F b) { return _mm_mul_ps(a, b); }
+    static F div(F a, F b) { return _mm_div_ps(a, b); }
+    static F fmadd(F a, F b, F c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+    static F floor(F a) {
+        // truncate, then step down the negative values that were rounded up
+        F truncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(a));
+        return _mm_sub_ps(truncated, _mm_and_ps(_mm_cmpgt_ps(truncated, a), _mm_set1_ps(1.0f)));
+    }
+    static F copySign(F a, F b) {
+        const F signBit = _mm_set1_ps(-0.0f);
+        return _mm_or_ps(_mm_andnot_ps(signBit, a), _mm_and_ps(signBit, b));
+    }
+    static F rsqrt(F a) {
+        // the 12 bits estimate, refined by a Newton step: y (1.5 - 0.5 a y^2)
+        F y = _mm_rsqrt_ps(a);
+        F halfAyy = _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(0.5f), a), _mm_mul_ps(y, y));
+        return _mm_mul_ps(y, _mm_sub_ps(_mm_set1_ps(1.5f), halfAyy));
+    }
+};
+#endif
+
+#ifdef SIMD_LANES_AVX2
+/**
+ * Eight floats per lane
+*/
+struct Avx2Lanes{
+    using F = __m256;
+    static const int Width = 8;
+    SIMD_AVX2_TARGET static F set1(GLfloat a) { return _mm256_set1_ps(a); }
+    SIMD_AVX2_TARGET static F load(const GLfloat* a) { return _mm256_loadu_ps(a); }
+    SIMD_AVX2_TARGET static void store(GLfloat* a, F b) { _mm256_storeu_ps(a, b); }
+    SIMD_AVX2_TARGET static F add(F a, F b) { return _mm256_add_ps(a, b); }
+    SIMD_AVX2_TARGET static F sub(F a, F b) { return _mm256_sub_ps(a, b); }
+    SIMD_AVX2_TARGET static F mul(F a, F b) { return _mm256_mul_ps(a, b); }
+    SIMD_AVX2_TARGET static F div(F a, F b) { return _mm256_div_ps(a, b); }
+    SIMD_AVX2_TARGET static F fmadd(F a, F b, F c) { return _mm256_fmadd_ps(a, b, c); }
+    SIMD_AVX2_TARGET static F floor(F a) { return _mm256_floor_ps(a); }
+    SIMD_AVX2_TARGET static F copySign(F a, F b) {
+        const F signBit = _mm256_set1_ps(-0.0f);
+        return _mm256_or_ps(_mm256_andnot_ps(signBit, a), _mm256_and_ps(signBit, b));
+    }
+    SIMD_AVX2_TARGET static F rsqrt(F a) {
+        // the 12 bits estimate, refined by a Newton step: y (1.5 - 0.5 a y^2)
+        F y = _mm256_rsqrt_ps(a);
+        F halfAyy = _mm256_mul_ps(_mm256_mul_ps(_mm256_set1_ps(0.5f), a), _mm256_mul_ps(y, y));
+        return _mm256_mul_ps(y, _mm256_sub_ps(_mm256_set1_ps(1.5f), halfAyy));
+    }
+};
+#endif
+
+}
+
+#endif
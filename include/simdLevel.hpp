@@ -0,0 +1,19 @@
+#ifndef __SIMD_LEVEL_HPP__
+#define __SIMD_LEVEL_HPP__
+
+/**
+ * @enum The instruction sets the batched kernels can run on
+*/
+enum SimdLevel{
+    SIMD_SCALAR,
+    SIMD_SSE,
+    SIMD_AVX2,
+};
+
+/**
+ * Get the best instruction set supported by the processor
+ * @return The instruction set used by default
+*/
+SimdLevel detectSimdLevel();
+
+#endif
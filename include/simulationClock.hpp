@@ -0,0 +1,167 @@
+#ifndef __SIMULATION_CLOCK_HPP__
+#define __SIMULATION_CLOCK_HPP__
+
+#include <cstdio>
+#include <glad/gl.h>
+
+#include "errorHandler.hpp"
+
+/**
+ * The default number of simulation steps per second
+*/
+const static GLdouble kDefaultSimulationRate = 60.0;
+
+/**
+ * The default maximal number of steps run in one frame, the late time is dropped beyond it
+*/
+const static GLuint kDefaultMaxStepsPerFrame = 8;
+
+/**
+ * The largest time scale, simulated seconds per real second
+*/
+const static GLdouble kMaxTimeScale = 1e7;
+
+/**
+ * A clock advancing the simulation by fixed steps, whatever the frame rate.
+ * The time scale stretches the simulated duration of the steps, their number per second doesn't change
+*/
+class SimulationClock{
+    private:
+        /**
+         * The duration of a step, in real seconds
+        */
+        GLdouble _StepSize = 1.0 / kDefaultSimulationRate;
+
+        /**
+         * The number of simulated seconds per real second
+        */
+        GLdouble _TimeScale = 1.0;
+
+        /**
+         * The simulation time, in simulated seconds
+        */
+        GLdouble _Time = 0.0;
+
+        /**
+         * The elapsed time not simulated yet
+        */
+        GLdouble _Accumulator = 0.0;
+
+        /**
+         * The maximal number of steps run in one frame
+        */
+        GLuint _MaxStepsPerFrame = kDefaultMaxStepsPerFrame;
+
+    public:
+        /**
+         * A basic constructor
+         * @param rate The number of steps per second
+        */
+        SimulationClock(GLdouble rate = kDefaultSimulationRate){
+            setRate(rate);
+        }
+
+        /**
+         * Set the number of steps per second
+         * @param rate The number of steps per second
+        */
+        void setRate(GLdouble rate){
+            if(rate <= 0.0){
+                fprintf(stderr, "The simulation rate must be positive!\n");
+                ErrorHandler::handle(ErrorCodes::BAD_VALUE, ErrorLevel::WARNING);
+                return;
+            }
+            _StepSize = 1.0 / rate;
+        }
+
+        /**
+         * Set the maximal number of steps run in one frame
+         * @param maxSteps The maximal number of steps
+        */
+        void setMaxStepsPerFrame(GLuint maxSteps){
+            _MaxStepsPerFrame = maxSteps > 0 ? maxSteps : 1;
+        }
+
+        /**
+         * Set the number of simulated seconds per real second
+         * @param timeScale The time scale, between 1 and kMaxTimeScale
+        */
+        void setTimeScale(GLdouble timeScale){
+            if(timeScale < 1.0 || timeScale > kMaxTimeScale){
+                fprintf(stderr, "The time scale must be between 1 and %g!\n", kMaxTimeScale);
+                ErrorHandler::handle(ErrorCodes::OUT_OF_RANGE, ErrorLevel::WARNING);
+                timeScale = timeScale < 1.0 ? 1.0 : kMaxTimeScale;
+            }
+            _TimeScale = timeScale;
+        }
+
+        /**
+         * Get the number of simulated seconds per real second
+         * @return The time scale
+        */
+        GLdouble getTimeScale() const {
+            return _TimeScale;
+        }
+
+        /**
+         * Add the duration of a frame
+         * @param frameTime The real time elapsed since the last frame, in seconds
+         * @return The number of steps to run
+        */
+        GLuint advance(GLdouble frameTime){
+            if(frameTime > 0.0) _Accumulator += frameTime;
+            GLuint nbSteps = _Accumulator / _StepSize;
+            if(nbSteps > _MaxStepsPerFrame){
+                // the simulation can't keep up, slow it down instead of falling further behind
+                nbSteps = _MaxStepsPerFrame;
+                _Accumulator = nbSteps * _StepSize;
+            }
+            return nbSteps;
+        }
+
+        /**
+         * Run one step
+         * @return The new simulation time
+         * @cond Only as many times as returned by advance
+        */
+        GLdouble step(){
+            _Accumulator -= _StepSize;
+            _Time += getSimulatedStepSize();
+            return _Time;
+        }
+
+        /**
+         * Get the simulation time
+         * @return The time, in simulated seconds
+        */
+        GLdouble getTime() const {
+            return _Time;
+        }
+
+        /**
+         * Get the duration of a step
+         * @return The duration, in real seconds
+        */
+        GLdouble getStepSize() const {
+            return _StepSize;
+        }
+
+        /**
+         * Get the simulated duration of a step
+         * @return The duration, in simulated seconds
+        */
+        GLdouble getSimulatedStepSize() const {
+            return _StepSize * _TimeScale;
+        }
+
+        /**
+         * Get how far the frame is between the last two steps
+         * @return The interpolation factor, between 0 and 1
+        */
+        GLfloat getAlpha() const {
+            GLdouble alpha = _Accumulator / _StepSize;
+            return alpha < 0.0 ? 0.0f : (alpha > 1.0 ? 1.0f : (GLfloat)alpha);
+        }
+};
+
+#endif
@@ -0,0 +1,78 @@
+#ifndef __SPSC_QUEUE_HPP__
+#define __SPSC_QUEUE_HPP__
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+/**
+ * The size of a cache line, the indices written by each side live on their own
+*/
+const static std::size_t kCacheLineSize = 64;
+
+/**
+ * A lock-free ring buffer between a single producer thread and a single consumer thread.
+ * Each side only writes its own index, the values are moved in and out of fixed slots
+ * @param T The type of the values, default constructible and movable
+ * @param Capacity The number of slots, a power of two
+*/
+template <typename T, std::size_t Capacity>
+class SpscQueue{
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "The capacity must be a power of two");
+
+    private:
+        /**
+         * The number of values read, written by the consumer
+        */
+        alignas(kCacheLineSize) std::atomic<std::size_t> _Head{0};
+
+        /**
+         * The number of values written, written by the producer
+        */
+        alignas(kCacheLineSize) std::atomic<std::size_t> _Tail{0};
+
+        /**
+         * The slots, indexed modulo the capacity
+        */
+        alignas(kCacheLineSize) std::array<T, Capacity> _Slots = {};
+
+    public:
+        /**
+         * Add a value, from the producer thread
+         * @param value The value, moved in the queue on success
+         * @return False if the queue is full
+        */
+        bool push(T& value){
+            const std::size_t tail = _Tail.load(std::memory_order_relaxed);
+            // the slot must have been read before it is written again
+            if(tail - _Head.load(std::memory_order_acquire) == Capacity) return false;
+            _Slots[tail & (Capacity - 1)] = std::move(value);
+            _Tail.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * Take the oldest value, from the consumer thread
+         * @param value Set to the value
+         * @return False if the queue is empty
+        */
+        bool pop(T& value){
+            const std::size_t head = _Head.load(std::memory_order_relaxed);
+            // the value must have been written before it is read
+            if(head == _Tail.load(std::memory_order_acquire)) return false;
+            value = std::move(_Slots[head & (Capacity - 1)]);
+            _Head.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * Tell if the queue is empty, exact from the consumer thread
+         * @return True if there is nothing to take
+        */
+        bool isEmpty() const {
+            return _Head.load(std::memory_order_relaxed) == _Tail.load(std::memory_order_acquire);
+        }
+};
+
+#endif
@@ -31,7 +31,8 @@ class Sun : public Planet{
         */
         Sun(const MaterialPointer& material, const ShadersPointer& shader, const glm::vec3& lightPos, const glm::vec3& lightCol)
             : Planet(material, shader){
-            _Light = LightPointer(new Light(LightType::PointLight, lightPos, lightCol, EntityPointer(this)));
+            // the light points back to the sun once it is shared, in addToScene
+            _Light = LightPointer(new Light(LightType::PointLight, lightPos, lightCol));
         }
 
         /**
@@ -40,6 +41,7 @@ class Sun : public Planet{
         */
         void addToScene(const ScenePointer& scene) override {
             Entity::addToScene(scene);
+            _Light->setEntity(shared_from_this());
             scene->addLight(_Light);
         }
 };
@@ -0,0 +1,353 @@
+#ifndef __TEXTURE_MANAGER_HPP__
+#define __TEXTURE_MANAGER_HPP__
+
+#include <condition_variable>
+#include <deque>
+#include <glad/gl.h>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+class Texture;
+using TexturePointer = std::shared_ptr<Texture>;
+
+class Sampler;
+using SamplerPointer = std::shared_ptr<Sampler>;
+
+class TextureManager;
+using TextureManagerPointer = std::shared_ptr<TextureManager>;
+
+/**
+ * The number of threads decoding the images
+*/
+const static GLuint kNbTextureDecoders = 2;
+
+/**
+ * The largest anisotropy of the linear samplers, clamped to the hardware's
+*/
+const static GLfloat kMaxAnisotropy = 16.0f;
+
+/**
+ * @enum The filters, the minifying ones also blend the mip levels
+*/
+enum Filtering{
+    LINEAR,
+    NEAREST,
+};
+
+/**
+ * @enum The wrappings of the texture coordinates out of [0, 1]
+*/
+enum Wrapping{
+    REPEAT,
+    MIRRORED_REPEAT,
+    CLAMP_TO_EDGE,
+    CLAMP_TO_BORDER,
+};
+
+/**
+ * A texture shared by the entities using the same image, with its whole mip chain, empty until its upload is done.
+ * It holds no sampling state, the entities sample it through a sampler
+ * @see TextureManager
+ * @see Sampler
+*/
+class Texture{
+    friend class TextureManager;
+
+    private:
+        /**
+         * The OpenGL texture, 0 until the upload
+        */
+        GLuint _Id = 0;
+
+        /**
+         * The image's path
+        */
+        std::string _FileName = "";
+
+        /**
+         * Tell if the image can't be loaded, the texture stays empty
+        */
+        GLboolean _IsFailed = false;
+
+    private:
+        /**
+         * A texture waiting for its image
+         * @param fileName The image's path
+        */
+        Texture(const std::string& fileName) : _FileName(fileName){}
+
+        /**
+         * Create the OpenGL texture, fill its first level and generate the others
+         * @param width The image's width
+         * @param height The image's height
+         * @param nbChannels The number of channels, 3 or 4
+         * @param pixels The pixels, or their offset in the bound pixel unpack buffer
+        */
+        void upload(GLsizei width, GLsizei height, GLint nbChannels, const void* pixels);
+
+    public:
+        /**
+         * Delete the OpenGL texture
+        */
+        ~Texture(){
+            if(_Id) glDeleteTextures(1, &_Id);
+        }
+
+        /**
+         * Get the texture Id
+         * @return The texture Id, 0 until the image is uploaded
+        */
+        GLuint getId() const {
+            return _Id;
+        }
+
+        /**
+         * Tell if the image has been uploaded
+         * @return True if the texture can be sampled
+        */
+        GLboolean isReady() const {
+            return _Id != 0;
+        }
+
+        /**
+         * Tell if the image can't be loaded
+         * @return True if the texture will stay empty
+        */
+        GLboolean isFailed() const {
+            return _IsFailed;
+        }
+
+        /**
+         * Get the image's path
+         * @return The path
+        */
+        const std::string& getFileName() const {
+            return _FileName;
+        }
+};
+
+/**
+ * A sampler object, shared by the entities sampling their textures the same way
+ * @see TextureManager::getSampler
+*/
+class Sampler{
+    private:
+        /**
+         * The OpenGL sampler
+        */
+        GLuint _Id = 0;
+
+    public:
+        /**
+         * Create a sampler
+         * @param minFilter The minifying filter, between the two nearest mip levels
+         * @param magFilter The magnifying filter
+         * @param wrapS The wrapping property of the texture for the S axis
+         * @param wrapT The wrapping property of the texture for the T axis
+         * @param anisotropy The anisotropy of the filtering, 1 to disable it
+        */
+        Sampler(Filtering minFilter, Filtering magFilter, Wrapping wrapS, Wrapping wrapT, GLfloat anisotropy);
+
+        /**
+         * Delete the OpenGL sampler
+        */
+        ~Sampler(){
+            glDeleteSamplers(1, &_Id);
+        }
+
+        /**
+         * Get the sampler Id
+         * @return The sampler Id
+        */
+        GLuint getId() const {
+            return _Id;
+        }
+};
+
+/**
+ * The stages of a texture's loading, alternating between the decoders and the OpenGL thread
+*/
+enum TextureStage{
+    DECODING,
+    DECODED,
+    COPYING,
+    COPIED,
+};
+
+/**
+ * A texture being loaded
+*/
+struct TextureUpload{
+    /**
+     * The texture to fill
+    */
+    TexturePointer _Texture;
+
+    /**
+     * The current stage, changed by the thread working on it
+    */
+    TextureStage _Stage = DECODING;
+
+    /**
+     * The decoded pixels, nullptr if the image can't be read
+    */
+    unsigned char* _Pixels = nullptr;
+
+    /**
+     * The image's size and number of channels
+    */
+    GLint _Width = 0;
+    GLint _Height = 0;
+    GLint _NbChannels = 0;
+
+    /**
+     * The pixel unpack buffer and its mapping, filled by a decoder
+    */
+    GLuint _Buffer = 0;
+    void* _Mapping = nullptr;
+};
+
+using TextureUploadPointer = std::shared_ptr<TextureUpload>;
+
+/**
+ * The cache of the textures, by path, and of the samplers. The images are decoded and copied in pixel buffers by
+ * worker threads, the OpenGL thread only maps the buffers and starts the transfers: the entities are drawn without
+ * their texture until it is ready, and an image used by several entities is loaded once
+*/
+class TextureManager{
+    private:
+        /**
+         * The static instance of the texture manager
+        */
+        static TextureManagerPointer _Instance;
+
+        /**
+         * The textures, released with the last entity using them
+        */
+        std::unordered_map<std::string, std::weak_ptr<Texture>> _Textures = {};
+
+        /**
+         * The samplers, by filters and wrapping, released with the last entity using them
+        */
+        std::unordered_map<GLuint, std::weak_ptr<Sampler>> _Samplers = {};
+
+        /**
+         * The anisotropy of the linear samplers, 0 until the hardware is asked for its largest one
+        */
+        GLfloat _Anisotropy = 0.0f;
+
+        /**
+         * The worker threads
+        */
+        std::vector<std::thread> _Workers = {};
+
+        /**
+         * The loadings waiting for a worker
+        */
+        std::deque<TextureUploadPointer> _Jobs = {};
+
+        /**
+         * The loadings done by the workers, waiting for the OpenGL thread
+        */
+        std::vector<TextureUploadPointer> _Finished = {};
+
+        /**
+         * The number of loadings not done yet, counted on the OpenGL thread
+        */
+        GLuint _NbPending = 0;
+
+        /**
+         * Tell the workers to stop
+        */
+        bool _IsStopping = false;
+
+        /**
+         * The lock protecting the jobs and the finished loadings, and the condition the idle workers sleep on
+        */
+        std::mutex _Mutex;
+        std::condition_variable _WakeUp;
+
+    private:
+        /**
+         * Start the workers
+         * @param nbWorkers The number of worker threads
+        */
+        TextureManager(GLuint nbWorkers);
+
+        /**
+         * The loop of a worker thread
+        */
+        void work();
+
+        /**
+         * Give a loading to the workers
+         * @param upload The loading
+        */
+        void submit(const TextureUploadPointer& upload);
+
+        /**
+         * Map a pixel buffer for a decoded image, or upload it at once if it can't be mapped
+         * @param upload The loading
+        */
+        void map(const TextureUploadPointer& upload);
+
+        /**
+         * Upload a copied image from its pixel buffer
+         * @param upload The loading
+        */
+        void unmap(const TextureUploadPointer& upload);
+
+    public:
+        /**
+         * Stop and join the workers
+        */
+        ~TextureManager();
+
+        /**
+         * Get the unique instance of the texture manager
+         * @return The instance
+        */
+        static TextureManagerPointer getInstance(){
+            if(!_Instance){
+                _Instance = TextureManagerPointer(new TextureManager(kNbTextureDecoders));
+            }
+            return _Instance;
+        }
+
+        /**
+         * Get a texture, loaded in the background the first time its path is asked for
+         * @param fileName The image's path
+         * @return The texture, empty until its image is uploaded
+        */
+        TexturePointer load(const std::string& fileName);
+
+        /**
+         * Get the sampler of some filters and wrapping, created the first time they are asked for
+         * @param minFilter The minifying filter
+         * @param magFilter The magnifying filter
+         * @param wrapS The wrapping property of the texture for the S axis
+         * @param wrapT The wrapping property of the texture for the T axis
+         * @return The sampler, anisotropic if the minifying filter is linear
+        */
+        SamplerPointer getSampler(Filtering minFilter = LINEAR, Filtering magFilter = LINEAR,
+                                    Wrapping wrapS = REPEAT, Wrapping wrapT = REPEAT);
+
+        /**
+         * Move the loadings done by the workers to their next stage, on the OpenGL thread
+        */
+        void update();
+
+        /**
+         * Tell if textures are still being loaded
+         * @return True if a loading isn't done
+        */
+        GLboolean isLoading() const {
+            return _NbPending > 0;
+        }
+};
+
+#endif
@@ -0,0 +1,110 @@
+#ifndef __TRANSFORM_KERNEL_HPP__
+#define __TRANSFORM_KERNEL_HPP__
+
+#include <glad/gl.h>
+#include <glm/glm.hpp>
+
+#include "simdLevel.hpp"
+
+/**
+ * The structure of arrays read and written by the transform kernel, one entry per body.
+ * The axes must be normalized
+*/
+struct TransformBatch{
+    /**
+     * The index of each body's orbit center, -1 for the bodies without an orbit
+    */
+    const GLint* _Parents;
+
+    /**
+     * The orbits
+    */
+    const GLfloat* _OrbitSpeeds;
+    const GLfloat* _OrbitRadii;
+    const GLfloat* _OrbitAxesX;
+    const GLfloat* _OrbitAxesY;
+    const GLfloat* _OrbitAxesZ;
+
+    /**
+     * The Kepler orbits, eccentricity and mean motion zero for the other bodies
+    */
+    const GLfloat* _Eccentricities;
+    const GLfloat* _MeanMotions;
+    const GLfloat* _MeanAnomalies;
+
+    /**
+     * The directions of the periapsis scaled by the semi-major axes, zero for the bodies without a Kepler orbit
+    */
+    const GLfloat* _PeriapsesX;
+    const GLfloat* _PeriapsesY;
+    const GLfloat* _PeriapsesZ;
+
+    /**
+     * The directions 90 degrees ahead of the periapsis in the orbit plane scaled by the semi-minor axes
+    */
+    const GLfloat* _SemiMinorAxesX;
+    const GLfloat* _SemiMinorAxesY;
+    const GLfloat* _SemiMinorAxesZ;
+
+    /**
+     * The spins
+    */
+    const GLfloat* _RotationSpeeds;
+    const GLfloat* _RotationAxesX;
+    const GLfloat* _RotationAxesY;
+    const GLfloat* _RotationAxesZ;
+
+    /**
+     * The sizes, relative to the orbit center's size
+    */
+    const GLfloat* _Sizes;
+
+    /**
+     * The positions of the bodies without an orbit
+    */
+    const GLdouble* _OriginsX;
+    const GLdouble* _OriginsY;
+    const GLdouble* _OriginsZ;
+
+    /**
+     * The frames (model matrices without the spin), read for the orbit centers and written for the bodies
+    */
+    glm::mat4* _Frames;
+
+    /**
+     * The model matrices, written
+    */
+    glm::mat4* _Models;
+
+    /**
+     * The positions in double precision, read for the orbit centers and written for the bodies
+    */
+    glm::dvec3* _Positions;
+};
+
+/**
+ * Compute the frames and model matrices of a range of bodies, several bodies at a time.
+ * For each body: frame = parentFrame * T(kepler) * R(orbit) * T(orbitRadius, 0, 0) * S(size) and model = frame * R(spin),
+ * with the rotations built in closed form and the Kepler position solved with a fixed number of Newton iterations
+ * @param batch The bodies' arrays
+ * @param time The simulation time
+ * @param first The index of the first body
+ * @param last The index after the last body
+ * @param level The instruction set to use, it falls back to the best supported one
+ * @cond The orbit centers' frames must be up to date and outside of the range
+*/
+void buildTransforms(const TransformBatch& batch, GLdouble time, GLuint first, GLuint last, SimdLevel level = detectSimdLevel());
+
+/**
+ * Compute the positions of a range of bodies in double precision, one body at a time.
+ * The same translation as the frames' but with the angles and the sums kept in double,
+ * so that the small bodies stay steady on orbits of astronomical sizes
+ * @param batch The bodies' arrays
+ * @param time The simulation time
+ * @param first The index of the first body
+ * @param last The index after the last body
+ * @cond The orbit centers' frames and positions must be up to date and outside of the range
+*/
+void buildPositions(const TransformBatch& batch, GLdouble time, GLuint first, GLuint last);
+
+#endif
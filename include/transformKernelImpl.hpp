@@ -0,0 +1,305 @@
+#ifndef __TRANSFORM_KERNEL_IMPL_HPP__
+#define __TRANSFORM_KERNEL_IMPL_HPP__
+
+/**
+ * The body of the transform kernel, written once for every instruction set.
+ * Only included by the kernel's translation units, in an anonymous namespace like the lanes
+ * @see simdLanes.hpp
+*/
+
+#include <cmath>
+#include <glad/gl.h>
+
+#include "simdLanes.hpp"
+#include "transformKernel.hpp"
+
+/**
+ * Compute a range of bodies with AVX2
+ * @param batch The bodies' arrays
+ * @param time The simulation time
+ * @param first The index of the first body
+ * @param last The index after the last body
+ * @return False if the kernel was not compiled with AVX2
+*/
+bool buildTransformsAvx2(const TransformBatch& batch, GLdouble time, GLuint first, GLuint last);
+
+namespace {
+
+/**
+ * The number of Newton iterations solving Kepler's equation, enough for a float precision up to an eccentricity of 0.98.
+ * Fixed so that every lane runs the same instructions
+*/
+const static int kKeplerIterations = 6;
+
+/**
+ * Compute an angle in double precision and bring it back to [0, 2pi) before it is rounded to a float,
+ * so that the rotations stay precise however long the simulation runs
+ * @param speed The angular speed
+ * @param time The simulation time
+ * @return The angle
+*/
+inline GLfloat wrapAngle(GLfloat speed, GLdouble time){
+    const GLdouble twoPi = 6.283185307179586;
+    GLdouble angle = speed * time;
+    return (GLfloat)(angle - twoPi * std::floor(angle / twoPi));
+}
+
+/**
+ * Compute a mean anomaly in double precision and bring it back to [-pi, pi) before it is rounded to a float
+ * @param meanMotion The mean angular speed
+ * @param meanAnomaly The mean anomaly at the time zero
+ * @param time The simulation time
+ * @return The mean anomaly
+*/
+inline GLfloat wrapAnomaly(GLfloat meanMotion, GLfloat meanAnomaly, GLdouble time){
+    const GLdouble pi = 3.141592653589793;
+    GLdouble angle = meanAnomaly + meanMotion * time;
+    return (GLfloat)(angle - 2.0 * pi * std::floor((angle + pi) / (2.0 * pi)));
+}
+
+/**
+ * Compute the sine and cosine of each lane: Cody-Waite reduction to [-pi/4, pi/4] and minimax polynomials
+ * @param x The angles
+ * @param s Set to the sines
+ * @param c Set to the cosines
+*/
+template <typename L>
+SIMD_KERNEL_TARGET inline void sinCos(typename L::F x, typename L::F& s, typename L::F& c){
+    using F = typename L::F;
+    const F one = L::set1(1.0f);
+    const F two = L::set1(2.0f);
+    const F four = L::set1(4.0f);
+    const F half = L::set1(0.5f);
+    const F quarter = L::set1(0.25f);
+
+    // the quadrant and the angle in it
+    F q = L::floor(L::fmadd(x, L::set1(0.636619772367581f), half));
+    F r = L::fmadd(q, L::set1(-1.5703125f), x);
+    r = L::fmadd(q, L::set1(-4.837512969970703125e-4f), r);
+    r = L::fmadd(q, L::set1(-7.54978995489188216e-8f), r);
+    F r2 = L::mul(r, r);
+
+    F ps = L::fmadd(r2, L::set1(-1.9515295891e-4f), L::set1(8.3321608736e-3f));
+    ps = L::fmadd(r2, ps, L::set1(-1.6666654611e-1f));
+    ps = L::fmadd(L::mul(r2, r), ps, r);
+    F pc = L::fmadd(r2, L::set1(2.443315711809948e-5f), L::set1(-1.388731625493765e-3f));
+    pc = L::fmadd(r2, pc, L::set1(4.166664568298827e-2f));
+    pc = L::fmadd(L::mul(r2, r2), pc, L::fmadd(r2, L::set1(-0.5f), one));
+
+    // swap and negate by quadrant, with arithmetic instead of masks so that every lane type works
+    F qm = L::sub(q, L::mul(four, L::floor(L::mul(q, quarter))));
+    F high = L::floor(L::mul(qm, half));
+    F odd = L::sub(qm, L::add(high, high));
+    F sinSign = L::sub(one, L::mul(two, high));
+    F q1 = L::add(qm, one);
+    q1 = L::sub(q1, L::mul(four, L::floor(L::mul(q1, quarter))));
+    F cosSign = L::sub(one, L::mul(two, L::floor(L::mul(q1, half))));
+    s = L::mul(sinSign, L::fmadd(odd, L::sub(pc, ps), ps));
+    c = L::mul(cosSign, L::fmadd(odd, L::sub(ps, pc), pc));
+}
+
+/**
+ * Solve Kepler's equation E - e sin(E) = M for each lane, from Danby's initial guess E = M + 0.85 e sign(M)
+ * @param meanAnomaly The mean anomalies M, in [-pi, pi)
+ * @param eccentricity The eccentricities e, in [0, 1)
+ * @param s Set to the sines of the eccentric anomalies E
+ * @param c Set to the cosines of the eccentric anomalies E
+*/
+template <typename L>
+SIMD_KERNEL_TARGET inline void solveKepler(typename L::F meanAnomaly, typename L::F eccentricity, typename L::F& s, typename L::F& c){
+    using F = typename L::F;
+    const F one = L::set1(1.0f);
+    F e = L::fmadd(L::copySign(L::set1(0.85f), meanAnomaly), eccentricity, meanAnomaly);
+    for(int i=0; i<kKeplerIterations; i++){
+        sinCos<L>(e, s, c);
+        // f(E) = E - e sin(E) - M and f'(E) = 1 - e cos(E)
+        F f = L::sub(L::sub(e, L::mul(eccentricity, s)), meanAnomaly);
+        F df = L::sub(one, L::mul(eccentricity, c));
+        e = L::sub(e, L::div(f, df));
+    }
+    sinCos<L>(e, s, c);
+}
+
+/**
+ * Build rotation matrices around normalized axes in closed form
+ * @param x, y, z The axes
+ * @param s, c The sines and cosines of the angles
+ * @param rotation Set to the rotations, column major (rotation[column*3+row])
+*/
+template <typename L>
+SIMD_KERNEL_TARGET inline void rotation(typename L::F x, typename L::F y, typename L::F z, typename L::F s, typename L::F c, typename L::F* rotation){
+    using F = typename L::F;
+    F t = L::sub(L::set1(1.0f), c);
+    F tx = L::mul(t, x);
+    F ty = L::mul(t, y);
+    F tz = L::mul(t, z);
+    F sx = L::mul(s, x);
+    F sy = L::mul(s, y);
+    F sz = L::mul(s, z);
+    rotation[0] = L::fmadd(tx, x, c);
+    rotation[1] = L::fmadd(tx, y, sz);
+    rotation[2] = L::sub(L::mul(tx, z), sy);
+    rotation[3] = L::sub(L::mul(tx, y), sz);
+    rotation[4] = L::fmadd(ty, y, c);
+    rotation[5] = L::fmadd(ty, z, sx);
+    rotation[6] = L::fmadd(tx, z, sy);
+    rotation[7] = L::sub(L::mul(ty, z), sx);
+    rotation[8] = L::fmadd(tz, z, c);
+}
+
+/**
+ * Multiply 3x3 matrices, column major
+ * @param a, b The matrices
+ * @param result Set to a * b
+*/
+template <typename L>
+SIMD_KERNEL_TARGET inline void multiply3(const typename L::F* a, const typename L::F* b, typename L::F* result){
+    for(int column=0; column<3; column++){
+        for(int row=0; row<3; row++){
+            result[column*3+row] = L::fmadd(a[row], b[column*3],
+                                   L::fmadd(a[3+row], b[column*3+1],
+                                   L::mul(a[6+row], b[column*3+2])));
+        }
+    }
+}
+
+/**
+ * Compute the transforms of L::Width consecutive bodies
+ * @param batch The bodies' arrays
+ * @param time The simulation time
+ * @param first The index of the first body
+*/
+template <typename L>
+SIMD_KERNEL_TARGET inline void buildBlock(const TransformBatch& batch, GLdouble time, GLuint first){
+    using F = typename L::F;
+    const int W = L::Width;
+
+    // gather the orbit centers' frames, a body without an orbit sits in a translation to its origin
+    alignas(32) GLfloat parent[12][W];
+    alignas(32) GLfloat orbitAngle[W];
+    alignas(32) GLfloat orbitRadius[W];
+    alignas(32) GLfloat spinAngle[W];
+    alignas(32) GLfloat meanAnomaly[W];
+    bool hasKepler = false;
+    for(int k=0; k<W; k++){
+        const GLuint i = first + k;
+        const GLint p = batch._Parents[i];
+        if(p >= 0){
+            const GLfloat* frame = &batch._Frames[p][0][0];
+            for(int column=0; column<4; column++){
+                for(int row=0; row<3; row++){
+                    parent[column*3+row][k] = frame[column*4+row];
+                }
+            }
+            orbitAngle[k] = wrapAngle(batch._OrbitSpeeds[i], time);
+            orbitRadius[k] = batch._OrbitRadii[i];
+            meanAnomaly[k] = wrapAnomaly(batch._MeanMotions[i], batch._MeanAnomalies[i], time);
+            hasKepler |= batch._PeriapsesX[i] != 0.0f || batch._PeriapsesY[i] != 0.0f || batch._PeriapsesZ[i] != 0.0f;
+        } else {
+            for(int e=0; e<9; e++){
+                parent[e][k] = (e%4 == 0) ? 1.0f : 0.0f;
+            }
+            parent[9][k] = (GLfloat)batch._OriginsX[i];
+            parent[10][k] = (GLfloat)batch._OriginsY[i];
+            parent[11][k] = (GLfloat)batch._OriginsZ[i];
+            orbitAngle[k] = 0.0f;
+            orbitRadius[k] = 0.0f;
+            meanAnomaly[k] = 0.0f;
+        }
+        spinAngle[k] = wrapAngle(batch._RotationSpeeds[i], time);
+    }
+    F p[12];
+    for(int e=0; e<12; e++){
+        p[e] = L::load(parent[e]);
+    }
+
+    // the orbit and spin rotations
+    F s, c;
+    F orbit[9];
+    sinCos<L>(L::load(orbitAngle), s, c);
+    rotation<L>(L::load(batch._OrbitAxesX+first), L::load(batch._OrbitAxesY+first), L::load(batch._OrbitAxesZ+first), s, c, orbit);
+    F spin[9];
+    sinCos<L>(L::load(spinAngle), s, c);
+    rotation<L>(L::load(batch._RotationAxesX+first), L::load(batch._RotationAxesY+first), L::load(batch._RotationAxesZ+first), s, c, spin);
+
+    // the position on the Kepler orbit: a (cos(E) - e) along the periapsis and b sin(E) ahead of it,
+    // only solved when a body of the block has a Kepler orbit
+    F kepler[3] = {L::set1(0.0f), L::set1(0.0f), L::set1(0.0f)};
+    if(hasKepler){
+        const F eccentricity = L::load(batch._Eccentricities+first);
+        solveKepler<L>(L::load(meanAnomaly), eccentricity, s, c);
+        const F along = L::sub(c, eccentricity);
+        kepler[0] = L::fmadd(along, L::load(batch._PeriapsesX+first), L::mul(s, L::load(batch._SemiMinorAxesX+first)));
+        kepler[1] = L::fmadd(along, L::load(batch._PeriapsesY+first), L::mul(s, L::load(batch._SemiMinorAxesY+first)));
+        kepler[2] = L::fmadd(along, L::load(batch._PeriapsesZ+first), L::mul(s, L::load(batch._SemiMinorAxesZ+first)));
+    }
+
+    // frame = parent * T(kepler) * R(orbit) * T(radius, 0, 0) * S(size)
+    const F size = L::load(batch._Sizes+first);
+    const F radius = L::load(orbitRadius);
+    F frame[9];
+    multiply3<L>(p, orbit, frame);
+    F translation[3];
+    for(int row=0; row<3; row++){
+        // the orbit radius is along the first column of the orbit rotation
+        translation[row] = L::fmadd(radius, frame[row], p[9+row]);
+        translation[row] = L::fmadd(p[row], kepler[0], L::fmadd(p[3+row], kepler[1], L::fmadd(p[6+row], kepler[2], translation[row])));
+    }
+    for(int e=0; e<9; e++){
+        frame[e] = L::mul(frame[e], size);
+    }
+
+    // model = frame * R(spin)
+    F model[9];
+    multiply3<L>(frame, spin, model);
+
+    // scatter back to the matrices
+    alignas(32) GLfloat out[21][W];
+    for(int e=0; e<9; e++){
+        L::store(out[e], frame[e]);
+        L::store(out[9+e], model[e]);
+    }
+    for(int row=0; row<3; row++){
+        L::store(out[18+row], translation[row]);
+    }
+    for(int k=0; k<W; k++){
+        GLfloat* f = &batch._Frames[first+k][0][0];
+        GLfloat* m = &batch._Models[first+k][0][0];
+        for(int column=0; column<3; column++){
+            for(int row=0; row<3; row++){
+                f[column*4+row] = out[column*3+row][k];
+                m[column*4+row] = out[9+column*3+row][k];
+            }
+            f[column*4+3] = 0.0f;
+            m[column*4+3] = 0.0f;
+        }
+        for(int row=0; row<3; row++){
+            f[12+row] = out[18+row][k];
+            m[12+row] = out[18+row][k];
+        }
+        f[15] = 1.0f;
+        m[15] = 1.0f;
+    }
+}
+
+/**
+ * Compute the transforms of a range of bodies, L::Width at a time
+ * @param batch The bodies' arrays
+ * @param time The simulation time
+ * @param first The index of the first body
+ * @param last The index after the last body
+*/
+template <typename L>
+SIMD_KERNEL_TARGET inline void buildRange(const TransformBatch& batch, GLdouble time, GLuint first, GLuint last){
+    GLuint i = first;
+    for(; i+L::Width <= last; i+=L::Width){
+        buildBlock<L>(batch, time, i);
+    }
+    for(; i<last; i++){
+        buildBlock<ScalarLanes>(batch, time, i);
+    }
+}
+
+}
+
+#endif
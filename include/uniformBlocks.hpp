@@ -0,0 +1,86 @@
+#ifndef __UNIFORM_BLOCKS_HPP__
+#define __UNIFORM_BLOCKS_HPP__
+
+#include <glad/gl.h>
+#include <glm/glm.hpp>
+#include <string>
+
+/**
+ * @enum The binding points of the uniform blocks shared by all the shaders
+*/
+enum UniformBinding{
+    FRAME_BINDING = 0,
+    LIGHTS_BINDING = 1,
+};
+
+/**
+ * The names of the uniform blocks inside the shaders
+*/
+const static std::string kFrameBlockName = "FrameData";
+const static std::string kLightsBlockName = "Lights";
+
+/**
+ * The maximum number of lights of each type (must match MAX_SIZE in the shaders)
+*/
+const static GLuint kMaxLights = 128;
+
+/**
+ * The per frame camera data, laid out as the std140 "FrameData" block
+*/
+struct FrameBlock{
+    /**
+     * The view matrix
+    */
+    glm::mat4 _ViewMat = glm::mat4(1.0f);
+
+    /**
+     * The projection matrix
+    */
+    glm::mat4 _ProjMat = glm::mat4(1.0f);
+
+    /**
+     * The camera position (w is unused)
+    */
+    glm::vec4 _CamPos = glm::vec4(0.0f);
+};
+
+/**
+ * A light as seen by the shaders, laid out as a std140 struct
+*/
+struct LightData{
+    /**
+     * The light's world position (w is unused)
+    */
+    glm::vec4 _Position = glm::vec4(0.0f);
+
+    /**
+     * The light's color (w is unused)
+    */
+    glm::vec4 _Color = glm::vec4(0.0f);
+};
+
+/**
+ * The per frame light data, laid out as the std140 "Lights" block
+*/
+struct LightsBlock{
+    /**
+     * The number of lights (x: point lights, y: directional lights)
+    */
+    glm::ivec4 _NbLights = glm::ivec4(0);
+
+    /**
+     * The point lights
+    */
+    LightData _PointLights[kMaxLights];
+
+    /**
+     * The directional lights
+    */
+    LightData _DirectionalLights[kMaxLights];
+};
+
+static_assert(sizeof(FrameBlock) == 144, "FrameBlock must follow the std140 layout");
+static_assert(sizeof(LightData) == 32, "LightData must follow the std140 layout");
+static_assert(sizeof(LightsBlock) == 16 + 2*kMaxLights*sizeof(LightData), "LightsBlock must follow the std140 layout");
+
+#endif
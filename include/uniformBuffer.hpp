@@ -0,0 +1,69 @@
+#ifndef __UNIFORM_BUFFER_HPP__
+#define __UNIFORM_BUFFER_HPP__
+
+#include <glad/gl.h>
+#include <memory>
+
+/**
+ * A class handling a uniform buffer object holding one uniform block
+ * @tparam Block The std140 compatible structure stored in the buffer
+*/
+template <typename Block>
+class UniformBuffer{
+
+    private:
+        /**
+         * The uniform buffer object
+        */
+        GLuint _UBO = 0;
+
+        /**
+         * The binding point of the buffer
+        */
+        GLuint _Binding = 0;
+
+    public:
+        /**
+         * Create the buffer and attach it to a binding point
+         * @param binding The binding point
+         * @see UniformBinding
+        */
+        UniformBuffer(GLuint binding){
+            _Binding = binding;
+            glGenBuffers(1, &_UBO);
+            glBindBuffer(GL_UNIFORM_BUFFER, _UBO);
+            glBufferData(GL_UNIFORM_BUFFER, sizeof(Block), NULL, GL_DYNAMIC_DRAW);
+            glBindBufferBase(GL_UNIFORM_BUFFER, _Binding, _UBO);
+            glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        }
+
+        /**
+         * A basic destructor
+        */
+        ~UniformBuffer(){
+            glDeleteBuffers(1, &_UBO);
+        }
+
+        /**
+         * Upload the whole block
+         * @param block The data to upload
+        */
+        void update(const Block& block) const {
+            updateRange(block, 0, sizeof(Block));
+        }
+
+        /**
+         * Upload a part of the block
+         * @param block The data to upload
+         * @param offset The offset in bytes of the first byte to upload
+         * @param size The number of bytes to upload
+        */
+        void updateRange(const Block& block, GLintptr offset, GLsizeiptr size) const {
+            if(size <= 0) return;
+            glBindBuffer(GL_UNIFORM_BUFFER, _UBO);
+            glBufferSubData(GL_UNIFORM_BUFFER, offset, size, reinterpret_cast<const char*>(&block) + offset);
+            glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        }
+};
+
+#endif
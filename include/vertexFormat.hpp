@@ -0,0 +1,131 @@
+#ifndef __VERTEX_FORMAT_HPP__
+#define __VERTEX_FORMAT_HPP__
+
+#include <glad/gl.h>
+#include <initializer_list>
+#include <vector>
+
+/**
+ * @enum The locations of the per vertex attributes in the vertex shader
+*/
+enum VertexAttribute{
+    VERTEX_POSITION = 0,
+    VERTEX_COLOR = 1,
+    VERTEX_UV = 2,
+    VERTEX_NORMAL = 3,
+};
+
+/**
+ * @enum How an attribute is stored inside a vertex buffer
+*/
+enum AttributeEncoding{
+    FLOAT32,            // GL_FLOAT, 4 bytes per component
+    FLOAT16,            // GL_HALF_FLOAT, 2 bytes per component
+    UNORM8,             // GL_UNSIGNED_BYTE normalized, values in [0, 1]
+    SNORM_10_10_10_2,   // GL_INT_2_10_10_10_REV normalized, up to 3 components in [-1, 1]
+};
+
+using VertexBytes = std::vector<GLubyte>;
+
+/**
+ * An attribute inside a vertex format
+*/
+struct AttributeFormat{
+    /**
+     * The attribute's location in the vertex shader
+    */
+    VertexAttribute _Location;
+
+    /**
+     * The number of components read from the source data
+    */
+    GLint _Components;
+
+    /**
+     * The attribute's encoding
+    */
+    AttributeEncoding _Encoding;
+
+    /**
+     * The attribute's offset in bytes inside a vertex (computed by the vertex format)
+    */
+    GLuint _Offset = 0;
+};
+
+/**
+ * A class describing the layout of an interleaved vertex stream on the GPU
+*/
+class VertexFormat{
+
+    private:
+        /**
+         * The attributes, in the order of the source data
+        */
+        std::vector<AttributeFormat> _Attributes = {};
+
+        /**
+         * The size in bytes of a vertex
+        */
+        GLsizei _Stride = 0;
+
+        /**
+         * The number of source floats per vertex
+        */
+        GLuint _NbComponents = 0;
+
+    public:
+        /**
+         * A basic constructor
+         * @param attributes The attributes, in the order of the source data
+        */
+        VertexFormat(std::initializer_list<AttributeFormat> attributes);
+
+        /**
+         * Get the size in bytes of a vertex
+         * @return The stride
+        */
+        GLsizei getStride() const {
+            return _Stride;
+        }
+
+        /**
+         * Get the number of source floats per vertex
+         * @return The number of components
+        */
+        GLuint getNbComponents() const {
+            return _NbComponents;
+        }
+
+        /**
+         * Encode interleaved floats into the GPU layout
+         * @param source The source floats, getNbComponents() per vertex
+         * @param nbVertices The number of vertices
+         * @return The encoded vertex stream
+        */
+        VertexBytes encode(const GLfloat* source, GLuint nbVertices) const;
+
+        /**
+         * Set the attribute pointers of the bound vertex array to the bound vertex buffer
+        */
+        void bindAttributes() const;
+
+        /**
+         * The full precision static stream: float positions, uvs and normals (32 bytes)
+         * @return The format
+        */
+        static VertexFormat standard();
+
+        /**
+         * The packed static stream: float positions, half float uvs and 10:10:10:2 normals (20 bytes)
+         * @return The format
+        */
+        static VertexFormat packed();
+
+        /**
+         * The color stream: RGBA8 normalized colors (4 bytes)
+         * @return The format
+        */
+        static VertexFormat colors();
+};
+
+#endif
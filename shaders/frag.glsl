@@ -4,53 +4,31 @@ in vec4 fCol;
 in vec3 fNorm;
 in vec3 fPos;
 in vec2 fUvs;
+flat in vec4 fMaterial; // ambient, diffuse, specular, shininess
+flat in float fUseTex;
 
 out vec4 color;
 
-uniform vec3 camPos;
-uniform float fAmbient;
-uniform float fDiffuse;
-uniform float fSpecular;
-uniform float fShininess;
 uniform sampler2D fAlbedoTex;
-uniform int useTex;
-
-struct PointLight{
-    vec3 position;
-    vec3 color;
-    mat4 model;
-};
-
-struct DirectionalLight{
-    vec3 position;
-    vec3 color;
-    mat4 model;
-};
 
 const int MAX_SIZE = 128;
 
-uniform int NB_POINT_LIGHTS;
-uniform PointLight pointLights[MAX_SIZE];
-uniform int NB_DIRECTIONAL_LIGHTS;
-uniform DirectionalLight directionalLights[MAX_SIZE];
+layout(std140) uniform FrameData{
+    mat4 viewMat;
+    mat4 projMat;
+    vec4 camPos;
+};
 
-/**
- * Get the light's position
- * @param light The point light to get
-*/
-vec3 getLightPos(PointLight light){
-    vec4 tmp = light.model * vec4(light.position, 1.0);
-    return vec3(tmp.x, tmp.y, tmp.z);
-}
+struct Light{
+    vec4 position; // in world space
+    vec4 color;
+};
 
-/**
- * Get the light's position
- * @param light The directional light to get
-*/
-vec3 getLightPos(DirectionalLight light){
-    vec4 tmp = light.model * vec4(light.position, 1.0);
-    return vec3(tmp.x, tmp.y, tmp.z);
-}
+layout(std140) uniform Lights{
+    ivec4 nbLights; // x: point lights, y: directional lights
+    Light pointLights[MAX_SIZE];
+    Light directionalLights[MAX_SIZE];
+};
 
 /**
  * Get the ambient part of the model for one light
@@ -59,7 +37,7 @@ vec3 getLightPos(DirectionalLight light){
  * @return The ambient component
 */
 vec3 getAmbient(vec3 lColor, vec3 oColor){
-    return fAmbient * lColor * oColor;
+    return fMaterial.x * lColor * oColor;
 }
 
 
@@ -75,7 +53,7 @@ vec3 getDiffuse(vec3 lPos, vec3 lColor, vec3 oColor){
     vec3 lDir = normalize(lPos-fPos);
     vec3 nDir = normalize(fNorm);
     vec3 c = vec3(oColor.x*lColor.x, oColor.y*lColor.y, oColor.z*lColor.z);
-    return fDiffuse*max(0.0, dot(nDir, lDir))*c;
+    return fMaterial.y*max(0.0, dot(nDir, lDir))*c;
 }
 
 /**
@@ -88,13 +66,13 @@ vec3 getDiffuse(vec3 lPos, vec3 lColor, vec3 oColor){
 vec3 getSpecular(vec3 lPos, vec3 lColor, vec3 oColor){
     if(lPos == fPos) return vec3(0.);
     vec3 lDir = normalize(lPos-fPos);
-    vec3 camDir = normalize(camPos-fPos);
+    vec3 camDir = normalize(camPos.xyz-fPos);
     vec3 nDir = normalize(fNorm);
 
     vec3 h = normalize(lDir + camDir);
     vec3 c = vec3(oColor.x*lColor.x, oColor.y*lColor.y, oColor.z*lColor.z);
 
-    return fSpecular*pow(max(0., dot(nDir, h)), fShininess)*c;
+    return fMaterial.z*pow(max(0., dot(nDir, h)), fMaterial.w)*c;
 }
 
 /**
@@ -104,16 +82,16 @@ vec3 getSpecular(vec3 lPos, vec3 lColor, vec3 oColor){
 vec3 getAmbient(vec3 oColor){
     vec3 sum = vec3(0.);
     // point lights
-    int endLoop = int(min(NB_POINT_LIGHTS, MAX_SIZE));
+    int endLoop = min(nbLights.x, MAX_SIZE);
     for(int i=0; i<endLoop; i++){
-        vec3 lColor = pointLights[i].color;
+        vec3 lColor = pointLights[i].color.rgb;
         sum += getAmbient(lColor, oColor);
     }
 
     // directional lights
-    endLoop = int(min(NB_DIRECTIONAL_LIGHTS, MAX_SIZE));
+    endLoop = min(nbLights.y, MAX_SIZE);
     for(int i=0; i<endLoop; i++){
-        vec3 lColor = directionalLights[i].color;
+        vec3 lColor = directionalLights[i].color.rgb;
         sum += getAmbient(lColor, oColor);
     }
     return sum;
@@ -127,18 +105,18 @@ vec3 getAmbient(vec3 oColor){
 vec3 getDiffuse(vec3 oColor){
     vec3 sum = vec3(0.);
     // point lights
-    int endLoop = int(min(NB_POINT_LIGHTS, MAX_SIZE));
+    int endLoop = min(nbLights.x, MAX_SIZE);
     for(int i=0; i<endLoop; i++){
-        vec3 lPos = getLightPos(pointLights[i]);
-        vec3 lColor = pointLights[i].color;
+        vec3 lPos = pointLights[i].position.xyz;
+        vec3 lColor = pointLights[i].color.rgb;
         sum += getDiffuse(lPos, lColor, oColor);
     }
 
     // directional lights
-    endLoop = int(min(NB_DIRECTIONAL_LIGHTS, MAX_SIZE));
+    endLoop = min(nbLights.y, MAX_SIZE);
     for(int i=0; i<endLoop; i++){
-        vec3 lPos = getLightPos(directionalLights[i]);
-        vec3 lColor = directionalLights[i].color;
+        vec3 lPos = directionalLights[i].position.xyz;
+        vec3 lColor = directionalLights[i].color.rgb;
         sum += getDiffuse(lPos, lColor, oColor);
     }
     return sum;
@@ -151,18 +129,18 @@ vec3 getDiffuse(vec3 oColor){
 vec3 getSpecular(vec3 oColor){
     vec3 sum = vec3(0.);
     // point lights
-    int endLoop = int(min(NB_POINT_LIGHTS, MAX_SIZE));
+    int endLoop = min(nbLights.x, MAX_SIZE);
     for(int i=0; i<endLoop; i++){
-        vec3 lPos = pointLights[i].position;
-        vec3 lColor = pointLights[i].color;
+        vec3 lPos = pointLights[i].position.xyz;
+        vec3 lColor = pointLights[i].color.rgb;
         sum += getSpecular(lPos, lColor, oColor);
     }
 
     // directional lights
-    endLoop = int(min(NB_DIRECTIONAL_LIGHTS, MAX_SIZE));
+    endLoop = min(nbLights.y, MAX_SIZE);
     for(int i=0; i<endLoop; i++){
-        vec3 lPos = directionalLights[i].position;
-        vec3 lColor = directionalLights[i].color;
+        vec3 lPos = directionalLights[i].position.xyz;
+        vec3 lColor = directionalLights[i].color.rgb;
         sum += getSpecular(lPos, lColor, oColor);
     }
     return sum;
@@ -172,7 +150,7 @@ vec3 getSpecular(vec3 oColor){
  * The Phong model
 */
 void main(){
-    vec3 oColor = useTex != 0 ? texture(fAlbedoTex, fUvs).rgb : fCol.rgb;
+    vec3 oColor = fUseTex > 0.5 ? texture(fAlbedoTex, fUvs).rgb : fCol.rgb;
     vec3 ambient = getAmbient(oColor);
     vec3 diffuse = getDiffuse(oColor);
     vec3 specular = getSpecular(oColor);
@@ -5,30 +5,42 @@ layout(location = 1) in vec4 vCol;
 layout(location = 2) in vec2 vUvs;
 layout(location = 3) in vec3 vNorm;
 
+// per instance attributes (constant values when not instanced)
+layout(location = 4) in mat4 iModel;
+layout(location = 8) in vec4 iCol;
+layout(location = 9) in vec4 iMaterial;
+layout(location = 10) in float iUseTex;
+
 out vec4 fCol;
 out vec3 fNorm;
 out vec3 fPos;
 out vec2 fUvs;
+flat out vec4 fMaterial;
+flat out float fUseTex;
 
-uniform mat4 modelMat;
-uniform mat4 viewMat;
-uniform mat4 projMat;
+layout(std140) uniform FrameData{
+    mat4 viewMat;
+    mat4 projMat;
+    vec4 camPos;
+};
 
 vec4 getPositions(){
-    mat4 MVP = projMat * viewMat * modelMat;
+    mat4 MVP = projMat * viewMat * iModel;
     return MVP * vec4(vPos, 1.0);
 }
 
 vec3 getNormals(){
-    mat3 normalMatrix = transpose(inverse(mat3(modelMat)));
+    mat3 normalMatrix = transpose(inverse(mat3(iModel)));
     return normalize(normalMatrix * vNorm);
 }
 
 void main(){
     gl_Position = getPositions();
     //fCol = vec4((vNorm + 1.0) / 2.0, 1.0);
-    fCol = vCol;
+    fCol = vCol * iCol;
     fNorm = getNormals();
-    fPos = vec3(modelMat*vec4(vPos, 1.0));
+    fPos = vec3(iModel*vec4(vPos, 1.0));
     fUvs = vUvs;
+    fMaterial = iMaterial;
+    fUseTex = iUseTex;
 }
\ No newline at end of file
@@ -0,0 +1,428 @@
+#include "bodyStore.hpp"
+#include <algorithm>
+#include <glm/ext.hpp>
+#include "jobSystem.hpp"
+#include "transformKernel.hpp"
+
+BodyStorePointer BodyStore::_Instance = BodyStorePointer(nullptr);
+
+namespace {
+
+/**
+ * The number of bodies computed by a job
+*/
+const static GLuint kBodiesPerJob = 4096;
+
+/**
+ * Reorder an array
+ * @param values The array to reorder
+ * @param sorted The old index of each new position
+*/
+template <typename T>
+void permute(std::vector<T>& values, const std::vector<GLuint>& sorted){
+    std::vector<T> result(values.size());
+    for(size_t i=0; i<sorted.size(); i++){
+        result[i] = values[sorted[i]];
+    }
+    values.swap(result);
+}
+
+}
+
+BodyHandle BodyStore::create(){
+    BodyHandle handle;
+    if(!_FreeHandles.empty()){
+        handle = _FreeHandles.back();
+        _FreeHandles.pop_back();
+    } else {
+        handle = _Slots.size();
+        _Slots.push_back(kInvalidBody);
+        _NbSatellites.push_back(0);
+    }
+    _Slots[handle] = _Handles.size();
+    _Handles.push_back(handle);
+    _ParentHandles.push_back(kInvalidBody);
+    _Parents.push_back(-1);
+    _OrbitSpeeds.push_back(0.0f);
+    _OrbitRadii.push_back(0.0f);
+    _OrbitAxesX.push_back(0.0f);
+    _OrbitAxesY.push_back(1.0f);
+    _OrbitAxesZ.push_back(0.0f);
+    _Eccentricities.push_back(0.0f);
+    _MeanMotions.push_back(0.0f);
+    _MeanAnomalies.push_back(0.0f);
+    _PeriapsesX.push_back(0.0f);
+    _PeriapsesY.push_back(0.0f);
+    _PeriapsesZ.push_back(0.0f);
+    _SemiMinorAxesX.push_back(0.0f);
+    _SemiMinorAxesY.push_back(0.0f);
+    _SemiMinorAxesZ.push_back(0.0f);
+    _RotationSpeeds.push_back(0.0f);
+    _RotationAxesX.push_back(0.0f);
+    _RotationAxesY.push_back(1.0f);
+    _RotationAxesZ.push_back(0.0f);
+    _Sizes.push_back(1.0f);
+    _OriginsX.push_back(0.0);
+    _OriginsY.push_back(0.0);
+    _OriginsZ.push_back(0.0);
+    _Frames.push_back(glm::mat4(1.0f));
+    _Models.push_back(glm::mat4(1.0f));
+    _RenderFrames.push_back(glm::mat4(1.0f));
+    _RenderModels.push_back(glm::mat4(1.0f));
+    _Positions.push_back(glm::dvec3(0.0));
+    _PreviousPositions.push_back(glm::dvec3(0.0));
+    _RenderPositions.push_back(glm::dvec3(0.0));
+    _RenderOriginsX.push_back(0.0);
+    _RenderOriginsY.push_back(0.0);
+    _RenderOriginsZ.push_back(0.0);
+    _IsOrderDirty = true;
+    return handle;
+}
+
+void BodyStore::remove(BodyHandle handle){
+    const GLuint index = getSlot(handle);
+    setParent(index, kInvalidBody);
+    // only the bodies with satellites look for them
+    if(_NbSatellites[handle] > 0){
+        for(auto& parent : _ParentHandles){
+            if(parent == handle) parent = kInvalidBody;
+        }
+        _NbSatellites[handle] = 0;
+    }
+    // move the last body in the hole, the order is rebuilt before the next update
+    const GLuint last = _Handles.size()-1;
+    auto moveLast = [index, last](auto& values){
+        values[index] = values[last];
+        values.pop_back();
+    };
+    _Slots[_Handles[last]] = index;
+    moveLast(_Handles);
+    moveLast(_ParentHandles);
+    moveLast(_Parents);
+    moveLast(_OrbitSpeeds);
+    moveLast(_OrbitRadii);
+    moveLast(_OrbitAxesX);
+    moveLast(_OrbitAxesY);
+    moveLast(_OrbitAxesZ);
+    moveLast(_Eccentricities);
+    moveLast(_MeanMotions);
+    moveLast(_MeanAnomalies);
+    moveLast(_PeriapsesX);
+    moveLast(_PeriapsesY);
+    moveLast(_PeriapsesZ);
+    moveLast(_SemiMinorAxesX);
+    moveLast(_SemiMinorAxesY);
+    moveLast(_SemiMinorAxesZ);
+    moveLast(_RotationSpeeds);
+    moveLast(_RotationAxesX);
+    moveLast(_RotationAxesY);
+    moveLast(_RotationAxesZ);
+    moveLast(_Sizes);
+    moveLast(_OriginsX);
+    moveLast(_OriginsY);
+    moveLast(_OriginsZ);
+    moveLast(_Frames);
+    moveLast(_Models);
+    moveLast(_RenderFrames);
+    moveLast(_RenderModels);
+    moveLast(_Positions);
+    moveLast(_PreviousPositions);
+    moveLast(_RenderPositions);
+    moveLast(_RenderOriginsX);
+    moveLast(_RenderOriginsY);
+    moveLast(_RenderOriginsZ);
+    _Slots[handle] = kInvalidBody;
+    _FreeHandles.push_back(handle);
+    _IsOrderDirty = true;
+}
+
+void BodyStore::setParent(GLuint index, BodyHandle orbitCenter){
+    const BodyHandle previous = _ParentHandles[index];
+    if(previous == orbitCenter) return;
+    if(previous != kInvalidBody) _NbSatellites[previous]--;
+    if(orbitCenter != kInvalidBody) _NbSatellites[orbitCenter]++;
+    _ParentHandles[index] = orbitCenter;
+    _IsOrderDirty = true;
+}
+
+void BodyStore::setStill(BodyHandle handle, GLfloat size, GLfloat rotationSpeed, const glm::vec3& axis, const glm::dvec3& origin){
+    const GLuint index = getSlot(handle);
+    const glm::vec3 rotationAxis = glm::normalize(axis);
+    setParent(index, kInvalidBody);
+    _Sizes[index] = size;
+    _RotationSpeeds[index] = rotationSpeed;
+    _RotationAxesX[index] = rotationAxis.x;
+    _RotationAxesY[index] = rotationAxis.y;
+    _RotationAxesZ[index] = rotationAxis.z;
+    _OriginsX[index] = origin.x;
+    _OriginsY[index] = origin.y;
+    _OriginsZ[index] = origin.z;
+    setElements(index, OrbitalElements{0.0f});
+    _Frames[index] = glm::scale(glm::translate(glm::mat4(1.0f), glm::vec3(origin)), glm::vec3(size));
+    _Models[index] = _Frames[index];
+    _RenderFrames[index] = _Frames[index];
+    _RenderModels[index] = _Models[index];
+    _Positions[index] = origin;
+    _PreviousPositions[index] = origin;
+}
+
+void BodyStore::setOrbit(BodyHandle handle, GLfloat size, GLfloat rotationSpeed, const glm::vec3& axis,
+                        GLfloat orbitSpeed, const glm::vec3& orbitDirection, GLfloat orbitRadius, BodyHandle orbitCenter){
+    const GLuint index = getSlot(handle);
+    const glm::vec3 rotationAxis = glm::normalize(axis);
+    const glm::vec3 orbitAxis = glm::normalize(orbitDirection);
+    const GLuint center = getSlot(orbitCenter);
+    if(orbitCenter == handle){
+        fprintf(stderr, "A body can't orbit around itself!\n");
+        ErrorHandler::handle(ErrorCodes::BAD_VALUE);
+    }
+    setParent(index, orbitCenter);
+    _Sizes[index] = size;
+    _RotationSpeeds[index] = rotationSpeed;
+    _RotationAxesX[index] = rotationAxis.x;
+    _RotationAxesY[index] = rotationAxis.y;
+    _RotationAxesZ[index] = rotationAxis.z;
+    _OrbitSpeeds[index] = orbitSpeed;
+    _OrbitRadii[index] = orbitRadius;
+    _OrbitAxesX[index] = orbitAxis.x;
+    _OrbitAxesY[index] = orbitAxis.y;
+    _OrbitAxesZ[index] = orbitAxis.z;
+    setElements(index, OrbitalElements{0.0f});
+    _Frames[index] = glm::scale(glm::translate(glm::mat4(1.0f), glm::vec3(_Models[center][3]) + glm::vec3(orbitRadius, 0.0f, 0.0f)), glm::vec3(size));
+    _Models[index] = _Frames[index];
+    _RenderFrames[index] = _Frames[index];
+    _RenderModels[index] = _Models[index];
+    _Positions[index] = _Positions[center] + glm::dvec3(orbitRadius, 0.0, 0.0);
+    _PreviousPositions[index] = _Positions[index];
+}
+
+void BodyStore::setKepler(BodyHandle handle, GLfloat size, GLfloat rotationSpeed, const glm::vec3& axis,
+                        const OrbitalElements& elements, BodyHandle orbitCenter){
+    const GLuint index = getSlot(handle);
+    const glm::vec3 rotationAxis = glm::normalize(axis);
+    const GLuint center = getSlot(orbitCenter);
+    if(orbitCenter == handle){
+        fprintf(stderr, "A body can't orbit around itself!\n");
+        ErrorHandler::handle(ErrorCodes::BAD_VALUE);
+    }
+    if(elements._SemiMajorAxis <= 0.0f || elements._Eccentricity < 0.0f || elements._Eccentricity >= 1.0f){
+        fprintf(stderr, "A Kepler orbit needs a positive semi-major axis and an eccentricity in [0, 1)!\n");
+        ErrorHandler::handle(ErrorCodes::BAD_VALUE);
+    }
+    setParent(index, orbitCenter);
+    _Sizes[index] = size;
+    _RotationSpeeds[index] = rotationSpeed;
+    _RotationAxesX[index] = rotationAxis.x;
+    _RotationAxesY[index] = rotationAxis.y;
+    _RotationAxesZ[index] = rotationAxis.z;
+    // no circular orbit on top of the Kepler one
+    _OrbitSpeeds[index] = 0.0f;
+    _OrbitRadii[index] = 0.0f;
+    setElements(index, elements);
+    // start at the periapsis until the first update
+    const glm::vec3 periapsis = glm::vec3(_PeriapsesX[index], _PeriapsesY[index], _PeriapsesZ[index]) * (1.0f - elements._Eccentricity);
+    _Frames[index] = glm::scale(glm::translate(_Frames[center], periapsis), glm::vec3(size));
+    _Models[index] = _Frames[index];
+    _RenderFrames[index] = _Frames[index];
+    _RenderModels[index] = _Models[index];
+    _Positions[index] = _Positions[center] + glm::dvec3(glm::vec3(_Frames[index][3]) - glm::vec3(_Frames[center][3]));
+    _PreviousPositions[index] = _Positions[index];
+}
+
+void BodyStore::setElements(GLuint index, const OrbitalElements& elements){
+    const glm::vec3 periapsis = elements.getPeriapsisDirection() * elements._SemiMajorAxis;
+    const glm::vec3 semiMinor = elements.getSemiMinorDirection() * elements.getSemiMinorAxis();
+    _Eccentricities[index] = elements._Eccentricity;
+    _MeanMotions[index] = elements._MeanMotion;
+    _MeanAnomalies[index] = elements._MeanAnomaly;
+    _PeriapsesX[index] = periapsis.x;
+    _PeriapsesY[index] = periapsis.y;
+    _PeriapsesZ[index] = periapsis.z;
+    _SemiMinorAxesX[index] = semiMinor.x;
+    _SemiMinorAxesY[index] = semiMinor.y;
+    _SemiMinorAxesZ[index] = semiMinor.z;
+}
+
+void BodyStore::sortByDepth(){
+    const GLuint nbBodies = _Handles.size();
+
+    // the depth of each body, following the orbit centers until a known depth
+    std::vector<GLint> depths(nbBodies, -1);
+    std::vector<GLuint> chain;
+    GLint maxDepth = -1;
+    for(GLuint i=0; i<nbBodies; i++){
+        GLint body = i;
+        chain.clear();
+        while(body >= 0 && depths[body] < 0){
+            chain.push_back(body);
+            if(chain.size() > nbBodies){
+                fprintf(stderr, "The orbits contain a cycle!\n");
+                ErrorHandler::handle(ErrorCodes::BAD_VALUE);
+                return;
+            }
+            BodyHandle parent = _ParentHandles[body];
+            body = parent == kInvalidBody ? -1 : (GLint)_Slots[parent];
+        }
+        GLint depth = body >= 0 ? depths[body] : -1;
+        for(auto it = chain.rbegin(); it != chain.rend(); it++){
+            depths[*it] = ++depth;
+        }
+        maxDepth = std::max(maxDepth, depths[i]);
+    }
+
+    // counting sort by depth
+    _Levels.assign(maxDepth+2, 0);
+    for(GLuint i=0; i<nbBodies; i++){
+        _Levels[depths[i]+1]++;
+    }
+    for(GLuint level=1; level<_Levels.size(); level++){
+        _Levels[level] += _Levels[level-1];
+    }
+    std::vector<GLuint> sorted(nbBodies);
+    std::vector<GLuint> next(_Levels.begin(), _Levels.end()-1);
+    for(GLuint i=0; i<nbBodies; i++){
+        sorted[next[depths[i]]++] = i;
+    }
+
+    permute(_Handles, sorted);
+    permute(_ParentHandles, sorted);
+    permute(_OrbitSpeeds, sorted);
+    permute(_OrbitRadii, sorted);
+    permute(_OrbitAxesX, sorted);
+    permute(_OrbitAxesY, sorted);
+    permute(_OrbitAxesZ, sorted);
+    permute(_Eccentricities, sorted);
+    permute(_MeanMotions, sorted);
+    permute(_MeanAnomalies, sorted);
+    permute(_PeriapsesX, sorted);
+    permute(_PeriapsesY, sorted);
+    permute(_PeriapsesZ, sorted);
+    permute(_SemiMinorAxesX, sorted);
+    permute(_SemiMinorAxesY, sorted);
+    permute(_SemiMinorAxesZ, sorted);
+    permute(_RotationSpeeds, sorted);
+    permute(_RotationAxesX, sorted);
+    permute(_RotationAxesY, sorted);
+    permute(_RotationAxesZ, sorted);
+    permute(_Sizes, sorted);
+    permute(_OriginsX, sorted);
+    permute(_OriginsY, sorted);
+    permute(_OriginsZ, sorted);
+    permute(_Frames, sorted);
+    permute(_Models, sorted);
+    permute(_RenderFrames, sorted);
+    permute(_RenderModels, sorted);
+    permute(_Positions, sorted);
+    permute(_PreviousPositions, sorted);
+    permute(_RenderPositions, sorted);
+    permute(_RenderOriginsX, sorted);
+    permute(_RenderOriginsY, sorted);
+    permute(_RenderOriginsZ, sorted);
+
+    for(GLuint i=0; i<nbBodies; i++){
+        _Slots[_Handles[i]] = i;
+    }
+    for(GLuint i=0; i<nbBodies; i++){
+        BodyHandle parent = _ParentHandles[i];
+        _Parents[i] = parent == kInvalidBody ? -1 : (GLint)_Slots[parent];
+    }
+    _IsOrderDirty = false;
+    _IsOrderNew = true;
+}
+
+TransformBatch BodyStore::getBatch(){
+    TransformBatch batch;
+    batch._Parents = _Parents.data();
+    batch._OrbitSpeeds = _OrbitSpeeds.data();
+    batch._OrbitRadii = _OrbitRadii.data();
+    batch._OrbitAxesX = _OrbitAxesX.data();
+    batch._OrbitAxesY = _OrbitAxesY.data();
+    batch._OrbitAxesZ = _OrbitAxesZ.data();
+    batch._Eccentricities = _Eccentricities.data();
+    batch._MeanMotions = _MeanMotions.data();
+    batch._MeanAnomalies = _MeanAnomalies.data();
+    batch._PeriapsesX = _PeriapsesX.data();
+    batch._PeriapsesY = _PeriapsesY.data();
+    batch._PeriapsesZ = _PeriapsesZ.data();
+    batch._SemiMinorAxesX = _SemiMinorAxesX.data();
+    batch._SemiMinorAxesY = _SemiMinorAxesY.data();
+    batch._SemiMinorAxesZ = _SemiMinorAxesZ.data();
+    batch._RotationSpeeds = _RotationSpeeds.data();
+    batch._RotationAxesX = _RotationAxesX.data();
+    batch._RotationAxesY = _RotationAxesY.data();
+    batch._RotationAxesZ = _RotationAxesZ.data();
+    batch._Sizes = _Sizes.data();
+    batch._OriginsX = _OriginsX.data();
+    batch._OriginsY = _OriginsY.data();
+    batch._OriginsZ = _OriginsZ.data();
+    batch._Frames = _Frames.data();
+    batch._Models = _Models.data();
+    batch._Positions = _Positions.data();
+    return batch;
+}
+
+void BodyStore::update(BodyHandle handle, GLdouble time){
+    if(_IsOrderDirty) sortByDepth();
+    const GLuint index = getSlot(handle);
+    _PreviousPositions[index] = _Positions[index];
+    const TransformBatch batch = getBatch();
+    buildTransforms(batch, time, index, index+1);
+    buildPositions(batch, time, index, index+1);
+    _RenderModels[index] = _Models[index];
+}
+
+void BodyStore::update(GLdouble time){
+    if(_IsOrderDirty) sortByDepth();
+    _PreviousPositions.swap(_Positions);
+    // the first step has no previous one, the time doesn't go back to 0 before it
+    _PreviousTime = _HasStep ? _Time : time;
+    _Time = time;
+    _HasStep = true;
+    // the bodies of a depth only depend on the previous depths, they are computed in parallel batches
+    const TransformBatch batch = getBatch();
+    JobSystemPointer jobs = JobSystem::getInstance();
+    for(GLuint level=0; level+1<_Levels.size(); level++){
+        jobs->parallelFor(_Levels[level], _Levels[level+1], kBodiesPerJob, [&batch, time](GLuint first, GLuint last){
+            buildTransforms(batch, time, first, last);
+            buildPositions(batch, time, first, last);
+        });
+    }
+    // the bodies added or moved since the last step have no previous step to blend with
+    if(_IsOrderNew){
+        _PreviousPositions = _Positions;
+        _IsOrderNew = false;
+    }
+}
+
+void BodyStore::interpolate(GLfloat alpha, const glm::dvec3& origin){
+    if(_IsOrderDirty) sortByDepth();
+    // a blend of the matrices would cut the chords of the fast orbits and shrink the fast spins under time warp
+    const GLdouble time = _PreviousTime + (GLdouble)alpha * (_Time - _PreviousTime);
+    TransformBatch batch = getBatch();
+    batch._OriginsX = _RenderOriginsX.data();
+    batch._OriginsY = _RenderOriginsY.data();
+    batch._OriginsZ = _RenderOriginsZ.data();
+    batch._Frames = _RenderFrames.data();
+    batch._Models = _RenderModels.data();
+    batch._Positions = _RenderPositions.data();
+    JobSystemPointer jobs = JobSystem::getInstance();
+    for(GLuint level=0; level+1<_Levels.size(); level++){
+        jobs->parallelFor(_Levels[level], _Levels[level+1], kBodiesPerJob, [this, &batch, level, time, alpha, origin](GLuint first, GLuint last){
+            // the roots are moved by steps from the outside, by the gravity or the ephemeris
+            if(level == 0){
+                for(GLuint i=first; i<last; i++){
+                    const glm::dvec3 position = _PreviousPositions[i] + (GLdouble)alpha * (_Positions[i] - _PreviousPositions[i]);
+                    _RenderOriginsX[i] = position.x;
+                    _RenderOriginsY[i] = position.y;
+                    _RenderOriginsZ[i] = position.z;
+                }
+            }
+            buildTransforms(batch, time, first, last);
+            buildPositions(batch, time, first, last);
+            // only the small difference to the origin is rounded to float, the frames keep the translations of the satellites
+            for(GLuint i=first; i<last; i++){
+                _RenderModels[i][3] = glm::vec4(glm::vec3(_RenderPositions[i] - origin), 1.0f);
+            }
+        });
+    }
+}
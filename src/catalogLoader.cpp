@@ -0,0 +1,166 @@
+#include "catalogLoader.hpp"
+#include "errorHandler.hpp"
+#include "planet.hpp"
+#include "scene.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+/**
+ * The most numbers on a line: the position, the size and the color
+*/
+const static GLuint kMaxCatalogNumbers = 7;
+
+/**
+ * The rotation axis of the catalog bodies, which don't spin
+*/
+const static glm::vec3 kCatalogRotationAxis = glm::vec3(0.0f, 1.0f, 0.0f);
+
+/**
+ * Tell if a character is a space of a line
+ * @param c The character
+ * @return True for the spaces, the tabs and the carriage returns
+*/
+bool isBlank(char c){
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+}
+
+CatalogLoader::~CatalogLoader(){
+    _IsStopping.store(true, std::memory_order_relaxed);
+    if(_Worker.joinable()) _Worker.join();
+    if(_File) fclose(_File);
+}
+
+CatalogLoaderPointer CatalogLoader::start(const std::string& fileName, const MaterialPointer& material,
+                                            const ShadersPointer& shader, const glm::vec4& color){
+    FILE* file = fopen(fileName.c_str(), "rb");
+    if(!file){
+        fprintf(stderr, "Failed to read the catalog: %s!\n", fileName.c_str());
+        ErrorHandler::handle(ErrorCodes::READ_FILE_ERROR, ErrorLevel::WARNING);
+        return nullptr;
+    }
+    CatalogLoaderPointer loader(new CatalogLoader(file, fileName, material, shader, color));
+    loader->_Worker = std::thread(&CatalogLoader::read, loader.get());
+    return loader;
+}
+
+void CatalogLoader::parseLine(const char* begin, const char* end, CatalogBatch& batch){
+    while(begin < end && isBlank(*begin)) begin++;
+    if(begin == end || *begin == '#') return;
+
+    // strtod skips the line breaks too, a number must end on its own line
+    GLdouble numbers[kMaxCatalogNumbers];
+    GLuint nbNumbers = 0;
+    const char* cursor = begin;
+    while(nbNumbers < kMaxCatalogNumbers){
+        while(cursor < end && isBlank(*cursor)) cursor++;
+        if(cursor == end) break;
+        char* numberEnd = nullptr;
+        numbers[nbNumbers] = strtod(cursor, &numberEnd);
+        if(numberEnd == cursor || numberEnd > end) break;
+        cursor = numberEnd;
+        nbNumbers++;
+    }
+    while(cursor < end && isBlank(*cursor)) cursor++;
+
+    const GLboolean hasColor = nbNumbers == kMaxCatalogNumbers;
+    if(cursor != end || (nbNumbers != 4 && !hasColor) || !(numbers[3] > 0.0) || !std::isfinite(numbers[3])){
+        _NbMalformed.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    CatalogBody body;
+    body._Position = glm::dvec3(numbers[0], numbers[1], numbers[2]);
+    body._Size = (GLfloat)numbers[3];
+    body._Color = hasColor ? glm::vec4(numbers[4], numbers[5], numbers[6], 1.0) : _Color;
+    batch.push_back(body);
+}
+
+bool CatalogLoader::send(CatalogBatch& batch){
+    while(!_Filled.push(batch)){
+        // the main thread adds the bodies within its budget, the reading waits for it
+        if(_IsStopping.load(std::memory_order_relaxed)) return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    // fill a batch the main thread is done with, the reading doesn't allocate anymore
+    if(!_Empty.pop(batch)) batch = CatalogBatch();
+    batch.clear();
+    batch.reserve(kCatalogBatchSize);
+    return true;
+}
+
+void CatalogLoader::read(){
+    CatalogBatch batch;
+    batch.reserve(kCatalogBatchSize);
+    // the chunk is terminated, the numbers can't be read past it
+    std::vector<char> chunk(kCatalogChunkSize + 1);
+    // the start of a line cut by the chunk's end
+    std::string cut = "";
+    GLboolean isStopped = false;
+
+    while(!isStopped && !_IsStopping.load(std::memory_order_relaxed)){
+        const std::size_t nbRead = fread(chunk.data(), 1, kCatalogChunkSize, _File);
+        if(nbRead == 0) break;
+        chunk[nbRead] = '\0';
+        const char* line = chunk.data();
+        const char* end = line + nbRead;
+        while(!isStopped){
+            const char* lineEnd = (const char*)memchr(line, '\n', end - line);
+            if(!lineEnd) break;
+            if(cut.empty()){
+                parseLine(line, lineEnd, batch);
+            } else {
+                cut.append(line, lineEnd);
+                parseLine(cut.c_str(), cut.c_str() + cut.size(), batch);
+                cut.clear();
+            }
+            line = lineEnd + 1;
+            if(batch.size() >= kCatalogBatchSize) isStopped = !send(batch);
+        }
+        cut.append(line, end);
+    }
+
+    // the last line may have no line break
+    if(!isStopped && !cut.empty()) parseLine(cut.c_str(), cut.c_str() + cut.size(), batch);
+    if(!isStopped && !batch.empty()) send(batch);
+    fclose(_File);
+    _File = nullptr;
+    _IsRead.store(true, std::memory_order_release);
+}
+
+GLboolean CatalogLoader::addBodies(Scene& scene, GLdouble budget){
+    if(_IsDone) return false;
+    const auto start = std::chrono::steady_clock::now();
+    // the batches pushed before the end of the reading are all in the queue
+    const bool isRead = _IsRead.load(std::memory_order_acquire);
+
+    CatalogBatch batch;
+    Entities planets;
+    while(_Filled.pop(batch)){
+        planets.clear();
+        planets.reserve(batch.size());
+        for(const CatalogBody& body : batch){
+            PlanetPointer planet(new Planet(_Material, _Shader));
+            planet->setColor(body._Color);
+            planet->init(body._Size, 0.0f, kCatalogRotationAxis, body._Position);
+            planets.push_back(planet);
+        }
+        scene.addElements(planets);
+        _Empty.push(batch);
+        if(std::chrono::duration<GLdouble>(std::chrono::steady_clock::now() - start).count() >= budget) return true;
+    }
+    if(!isRead) return true;
+
+    _Worker.join();
+    const GLuint nbMalformed = _NbMalformed.load(std::memory_order_relaxed);
+    if(nbMalformed > 0){
+        fprintf(stderr, "%u lines of the catalog %s aren't bodies!\n", nbMalformed, _FileName.c_str());
+        ErrorHandler::handle(ErrorCodes::BAD_VALUE, ErrorLevel::WARNING);
+    }
+    _IsDone = true;
+    return false;
+}
@@ -6,5 +6,5 @@
  * @param scene The scene where to add the entity
 */
 void Entity::addToScene(const ScenePointer& scene){
-    scene->addElement(EntityPointer(this));
+    scene->addElement(shared_from_this());
 }
\ No newline at end of file
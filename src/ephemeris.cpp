@@ -0,0 +1,208 @@
+#include "ephemeris.hpp"
+#include "errorHandler.hpp"
+#include "jobSystem.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+/**
+ * The number of bodies evaluated by a job
+*/
+const static GLuint kBodiesPerJob = 1024;
+
+/**
+ * Evaluate a Chebyshev series with the Clenshaw recurrence
+ * @param coefficients The coefficients, lowest degree first
+ * @param nbCoefficients The number of coefficients
+ * @param x The variable, in [-1, 1]
+ * @return The sum of coefficients[j] * T_j(x)
+*/
+GLdouble evaluateChebyshev(const GLdouble* coefficients, GLuint nbCoefficients, GLdouble x){
+    GLdouble next = 0.0, afterNext = 0.0;
+    for(GLuint j=nbCoefficients-1; j>0; j--){
+        const GLdouble current = 2.0 * x * next - afterNext + coefficients[j];
+        afterNext = next;
+        next = current;
+    }
+    return x * next - afterNext + coefficients[0];
+}
+
+}
+
+Ephemeris::~Ephemeris(){
+#ifdef _WIN32
+    if(_Data) UnmapViewOfFile(_Data);
+    if(_Mapping) CloseHandle(_Mapping);
+    if(_File) CloseHandle(_File);
+#else
+    if(_Data) munmap((void*)_Data, _Size);
+#endif
+}
+
+GLboolean Ephemeris::map(const std::string& fileName){
+#ifdef _WIN32
+    HANDLE file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, nullptr);
+    if(file == INVALID_HANDLE_VALUE) return false;
+    _File = file;
+    LARGE_INTEGER size;
+    if(!GetFileSizeEx(file, &size) || size.QuadPart == 0) return false;
+    _Size = (std::size_t)size.QuadPart;
+    _Mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if(!_Mapping) return false;
+    _Data = (const std::uint8_t*)MapViewOfFile(_Mapping, FILE_MAP_READ, 0, 0, 0);
+    return _Data != nullptr;
+#else
+    const int file = open(fileName.c_str(), O_RDONLY);
+    if(file < 0) return false;
+    struct stat status;
+    if(fstat(file, &status) != 0 || status.st_size == 0){
+        close(file);
+        return false;
+    }
+    _Size = (std::size_t)status.st_size;
+    void* data = mmap(nullptr, _Size, PROT_READ, MAP_PRIVATE, file, 0);
+    // the mapping keeps the file open
+    close(file);
+    if(data == MAP_FAILED) return false;
+    // the segments are read by time window, reading ahead would load the next bodies' pages for nothing
+    madvise(data, _Size, MADV_RANDOM);
+    _Data = (const std::uint8_t*)data;
+    return true;
+#endif
+}
+
+GLboolean Ephemeris::validate(const std::string& fileName){
+    if(_Size < sizeof(EphemerisHeader)){
+        fprintf(stderr, "The ephemeris %s has no header!\n", fileName.c_str());
+        return false;
+    }
+    const EphemerisHeader* header = (const EphemerisHeader*)_Data;
+    if(std::memcmp(header->_Magic, kEphemerisMagic, sizeof(kEphemerisMagic)) != 0 || header->_Version != kEphemerisVersion){
+        fprintf(stderr, "The file %s isn't an ephemeris of version %u!\n", fileName.c_str(), kEphemerisVersion);
+        return false;
+    }
+    if((_Size - sizeof(EphemerisHeader)) / sizeof(EphemerisRecord) < header->_NbRecords){
+        fprintf(stderr, "The ephemeris %s is truncated!\n", fileName.c_str());
+        return false;
+    }
+    _Records = (const EphemerisRecord*)(_Data + sizeof(EphemerisHeader));
+    _NbRecords = header->_NbRecords;
+
+    for(GLuint i=0; i<_NbRecords; i++){
+        const EphemerisRecord& record = _Records[i];
+        if(record._NbSegments == 0 || record._NbCoefficients == 0 || record._NbCoefficients > kMaxChebyshevCoefficients
+            || !(record._SegmentDuration > 0.0) || record._Offset % 8 != 0 || record._Stride % 8 != 0){
+            fprintf(stderr, "The record %u of the ephemeris %s is malformed!\n", i, fileName.c_str());
+            return false;
+        }
+        // the last segment must end in the file, checked without overflowing
+        const std::uint64_t segmentSize = 3 * record._NbCoefficients * sizeof(GLdouble);
+        const std::uint64_t lastSegment = record._NbSegments - 1;
+        if(record._Offset > _Size || segmentSize > _Size - record._Offset
+            || (lastSegment > 0 && record._Stride > (_Size - record._Offset - segmentSize) / lastSegment)){
+            fprintf(stderr, "The segments of the record %u of the ephemeris %s are out of the file!\n", i, fileName.c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
+EphemerisPointer Ephemeris::load(const std::string& fileName){
+    EphemerisPointer ephemeris(new Ephemeris());
+    if(!ephemeris->map(fileName)){
+        fprintf(stderr, "Failed to map the file: %s!\n", fileName.c_str());
+        ErrorHandler::handle(ErrorCodes::READ_FILE_ERROR, ErrorLevel::WARNING);
+        return nullptr;
+    }
+    if(!ephemeris->validate(fileName)){
+        ErrorHandler::handle(ErrorCodes::BAD_VALUE, ErrorLevel::WARNING);
+        return nullptr;
+    }
+    return ephemeris;
+}
+
+glm::dvec2 Ephemeris::getTimeSpan(GLuint record) const {
+    if(record >= _NbRecords){
+        fprintf(stderr, "The ephemeris has no record %u!\n", record);
+        ErrorHandler::handle(ErrorCodes::OUT_OF_RANGE);
+    }
+    const EphemerisRecord& trajectory = _Records[record];
+    return glm::dvec2(trajectory._Start, trajectory._Start + trajectory._NbSegments * trajectory._SegmentDuration);
+}
+
+glm::dvec3 Ephemeris::getPosition(GLuint record, GLdouble time) const {
+    if(record >= _NbRecords){
+        fprintf(stderr, "The ephemeris has no record %u!\n", record);
+        ErrorHandler::handle(ErrorCodes::OUT_OF_RANGE);
+    }
+    const EphemerisRecord& trajectory = _Records[record];
+
+    // the segment of the time, its start mapped to -1 and its end to 1
+    const GLdouble elapsed = (time - trajectory._Start) / trajectory._SegmentDuration;
+    const GLdouble segment = std::min(std::max(std::floor(elapsed), 0.0), (GLdouble)(trajectory._NbSegments - 1));
+    const GLdouble x = std::min(std::max(2.0 * (elapsed - segment) - 1.0, -1.0), 1.0);
+
+    // only this segment's page is read
+    const GLuint nbCoefficients = trajectory._NbCoefficients;
+    const GLdouble* coefficients = (const GLdouble*)(_Data + trajectory._Offset + (std::uint64_t)segment * trajectory._Stride);
+    return glm::dvec3(evaluateChebyshev(coefficients, nbCoefficients, x),
+                        evaluateChebyshev(coefficients + nbCoefficients, nbCoefficients, x),
+                        evaluateChebyshev(coefficients + 2 * nbCoefficients, nbCoefficients, x));
+}
+
+void Ephemeris::bind(GLuint record, BodyHandle body){
+    if(record >= _NbRecords){
+        fprintf(stderr, "The ephemeris has no record %u!\n", record);
+        ErrorHandler::handle(ErrorCodes::OUT_OF_RANGE, ErrorLevel::WARNING);
+        return;
+    }
+    // a bound body only changes its trajectory
+    auto binding = _Bindings.find(body);
+    if(binding != _Bindings.end()){
+        _BodyRecords[binding->second] = record;
+        return;
+    }
+    _Bindings[body] = _Bodies.size();
+    _Bodies.push_back(body);
+    _BodyRecords.push_back(record);
+}
+
+void Ephemeris::unbind(BodyHandle body){
+    auto binding = _Bindings.find(body);
+    if(binding == _Bindings.end()){
+        fprintf(stderr, "The ephemeris doesn't move the body %d!\n", body);
+        ErrorHandler::handle(ErrorCodes::OUT_OF_RANGE, ErrorLevel::WARNING);
+        return;
+    }
+    const GLuint index = binding->second;
+    _Bindings.erase(binding);
+    // move the last binding in the hole
+    if(index + 1 < _Bodies.size()) _Bindings[_Bodies.back()] = index;
+    _Bodies[index] = _Bodies.back();
+    _Bodies.pop_back();
+    _BodyRecords[index] = _BodyRecords.back();
+    _BodyRecords.pop_back();
+}
+
+void Ephemeris::moveBodies(GLdouble time) const {
+    BodyStorePointer store = BodyStore::getInstance();
+    // each job writes the origins of its own bodies
+    JobSystem::getInstance()->parallelFor(0, _Bodies.size(), kBodiesPerJob, [this, &store, time](GLuint first, GLuint last){
+        for(GLuint i=first; i<last; i++){
+            store->moveTo(_Bodies[i], getPosition(_BodyRecords[i], time));
+        }
+    });
+}
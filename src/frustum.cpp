@@ -0,0 +1,73 @@
+#include "frustum.hpp"
+
+#if defined(__SSE__) || defined(_M_X64)
+#include <xmmintrin.h>
+#define FRUSTUM_USE_SSE
+#endif
+
+Frustum::Frustum(const glm::mat4& viewProj){
+    // the rows of the matrix (glm is column major)
+    glm::vec4 rows[4];
+    for(GLuint i=0; i<4; i++){
+        rows[i] = glm::vec4(viewProj[0][i], viewProj[1][i], viewProj[2][i], viewProj[3][i]);
+    }
+    _Planes[LEFT_PLANE]   = rows[3] + rows[0];
+    _Planes[RIGHT_PLANE]  = rows[3] - rows[0];
+    _Planes[BOTTOM_PLANE] = rows[3] + rows[1];
+    _Planes[TOP_PLANE]    = rows[3] - rows[1];
+    _Planes[NEAR_PLANE]   = rows[3] + rows[2];
+    _Planes[FAR_PLANE]    = rows[3] - rows[2];
+    // normalize so that the plane equation gives a distance
+    for(auto& plane : _Planes){
+        const GLfloat length = glm::length(glm::vec3(plane));
+        // an infinite projection has no far plane, nothing is behind it
+        plane = length > 0.0f ? plane / length : glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+    }
+}
+
+GLboolean Frustum::isVisible(const glm::vec4& sphere) const {
+    if(sphere.w < 0.0f) return true;
+    for(const auto& plane : _Planes){
+        if(glm::dot(glm::vec3(plane), glm::vec3(sphere)) + plane.w < -sphere.w) return false;
+    }
+    return true;
+}
+
+void Frustum::cull(const BoundingSpheres& spheres, Visibilities& visible) const {
+    visible.resize(spheres.size());
+    size_t i = 0;
+
+#ifdef FRUSTUM_USE_SSE
+    const __m128 zero = _mm_setzero_ps();
+    for(; i+4 <= spheres.size(); i+=4){
+        // transpose four packed spheres into x, y, z and radius registers
+        __m128 x = _mm_loadu_ps(&spheres[i].x);
+        __m128 y = _mm_loadu_ps(&spheres[i+1].x);
+        __m128 z = _mm_loadu_ps(&spheres[i+2].x);
+        __m128 r = _mm_loadu_ps(&spheres[i+3].x);
+        _MM_TRANSPOSE4_PS(x, y, z, r);
+
+        // unbounded spheres are always visible
+        __m128 inside = _mm_cmplt_ps(r, zero);
+        __m128 allPlanes = _mm_cmpeq_ps(zero, zero);
+        const __m128 negR = _mm_sub_ps(zero, r);
+        for(const auto& plane : _Planes){
+            __m128 d = _mm_add_ps(
+                _mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(plane.x)), _mm_mul_ps(y, _mm_set1_ps(plane.y))),
+                _mm_add_ps(_mm_mul_ps(z, _mm_set1_ps(plane.z)), _mm_set1_ps(plane.w))
+            );
+            allPlanes = _mm_and_ps(allPlanes, _mm_cmpge_ps(d, negR));
+        }
+        int mask = _mm_movemask_ps(_mm_or_ps(inside, allPlanes));
+        visible[i]   = (mask >> 0) & 1;
+        visible[i+1] = (mask >> 1) & 1;
+        visible[i+2] = (mask >> 2) & 1;
+        visible[i+3] = (mask >> 3) & 1;
+    }
+#endif
+
+    // the remaining spheres
+    for(; i<spheres.size(); i++){
+        visible[i] = isVisible(spheres[i]);
+    }
+}
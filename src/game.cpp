@@ -1,6 +1,7 @@
 #include "game.hpp"
 #include "GLFW/glfw3.h"
 #include "scene.hpp"
+#include "textureManager.hpp"
 #include <GL/glext.h>
 
 /**
@@ -29,10 +30,23 @@ void Game::run(){
     // init the buffers
     _Scene->initMeshes();
 
+    // place everything at the start of the simulation
+    _Scene->update(_Clock.getTime());
+    _LastTimeFrame = glfwGetTime();
+
     while(!glfwWindowShouldClose(_Window.get())){
         // update
         update();
-        _Scene->update((float)glfwGetTime());
+        // add the bodies read in the background so far
+        _Scene->ingest(_IngestionBudget);
+        // upload the textures decoded in the background so far
+        TextureManager::getInstance()->update();
+        // run the simulation by fixed steps, the rendering happens between the last two
+        GLuint nbSteps = _Clock.advance(_Dt);
+        for(GLuint i=0; i<nbSteps; i++){
+            _Scene->update(_Clock.step(), _SimulationBudget / nbSteps);
+        }
+        _Scene->interpolate(_Clock.getAlpha());
 
         // render
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
@@ -64,6 +78,14 @@ void Game::inputCallback(GLFWwindow* window, int key, int scancode, int action,
         getInstance().get()->wireframeSwitchCommand();
     }
 
+    // speed up and slow down the simulated time with . and ,
+    if(key == GLFW_KEY_PERIOD && action == GLFW_PRESS){
+        getInstance().get()->timeWarpCommand(kTimeWarpFactor);
+    }
+    if(key == GLFW_KEY_COMMA && action == GLFW_PRESS){
+        getInstance().get()->timeWarpCommand(1.0 / kTimeWarpFactor);
+    }
+
     // move the camera using the arrows and f, b
     if(key == GLFW_KEY_LEFT){
         if(action == GLFW_PRESS)
@@ -0,0 +1,127 @@
+#include "geometry.hpp"
+
+const GLuint Geometry::_NB_ELEMENT_PER_VERTICES = VboType::VERTICES
+                                     + VboType::UVS
+                                     + VboType::NORMALS;
+
+Vbo Geometry::interleave(const Vertices& vertices, const Uvs& uvs, const Normals& normals){
+    if(vertices.empty()){
+        fprintf(stderr, "Vertices can't be empty!\n");
+        ErrorHandler::handle(ErrorCodes::OUT_OF_RANGE);
+    }
+    const GLuint nbVertices = vertices.size() / VboType::VERTICES;
+
+    // check sizes, empty lists are filled with zeros
+    if(!uvs.empty() && uvs.size() != nbVertices*VboType::UVS){
+        fprintf(stderr, "The number of uvs should correspond to the number of vertices! Given %d, expected: %d!\n", (int)uvs.size(), nbVertices*VboType::UVS);
+        ErrorHandler::handle(ErrorCodes::OUT_OF_RANGE);
+    }
+    if(!normals.empty() && normals.size() != nbVertices*VboType::NORMALS){
+        fprintf(stderr, "The number of normals should correspond to the number of vertices! Given %d, expected: %d!\n", (int)normals.size(), nbVertices*VboType::NORMALS);
+        ErrorHandler::handle(ErrorCodes::OUT_OF_RANGE);
+    }
+
+    Vbo vertexData = Vbo(nbVertices * _NB_ELEMENT_PER_VERTICES, 0.0f);
+    for(GLuint i=0; i<nbVertices; i++){
+        const GLuint idx   = i*_NB_ELEMENT_PER_VERTICES;
+        const GLuint vIdx  = i*VboType::VERTICES;
+        const GLuint uvIdx = i*VboType::UVS;
+        const GLuint nIdx  = i*VboType::NORMALS;
+
+        // set the vertices
+        vertexData[idx]   = vertices[vIdx];
+        vertexData[idx+1] = vertices[vIdx+1];
+        vertexData[idx+2] = vertices[vIdx+2];
+        // set the uvs
+        if(!uvs.empty()){
+            vertexData[idx+3] = uvs[uvIdx];
+            vertexData[idx+4] = uvs[uvIdx+1];
+        }
+        // set the normals
+        if(!normals.empty()){
+            vertexData[idx+5] = normals[nIdx];
+            vertexData[idx+6] = normals[nIdx+1];
+            vertexData[idx+7] = normals[nIdx+2];
+        }
+    }
+
+    return vertexData;
+}
+
+Geometry::Geometry(Vbo vertexData, Indices indices, const VertexFormat& format)
+    : _Format(format){
+    if(_Format.getNbComponents() != _NB_ELEMENT_PER_VERTICES){
+        fprintf(stderr, "The vertex format of a static stream must read %d floats per vertex!\n", _NB_ELEMENT_PER_VERTICES);
+        ErrorHandler::handle(ErrorCodes::BAD_VALUE);
+    }
+    if(vertexData.empty() || vertexData.size() % _NB_ELEMENT_PER_VERTICES != 0){
+        fprintf(stderr, "The static stream must hold %d floats per vertex!\n", _NB_ELEMENT_PER_VERTICES);
+        ErrorHandler::handle(ErrorCodes::OUT_OF_RANGE);
+    }
+    if(indices.empty()){
+        fprintf(stderr, "Indices can't be empty!\n");
+        ErrorHandler::handle(ErrorCodes::OUT_OF_RANGE);
+    }
+    _NbVertices = vertexData.size() / _NB_ELEMENT_PER_VERTICES;
+    _VertexData = std::move(vertexData);
+    _NbIndices = indices.size();
+    _Indices = std::move(indices);
+}
+
+void Geometry::upload(){
+    if(_IsUploaded) return;
+    glGenBuffers(1, &_VBO);
+    glGenBuffers(1, &_EBO);
+
+    // the static stream, encoded in the gpu layout
+    VertexBytes vboData = _Format.encode(_VertexData.data(), _NbVertices);
+    glBindBuffer(GL_ARRAY_BUFFER, _VBO);
+    glBufferData(GL_ARRAY_BUFFER, vboData.size(), vboData.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    // the ebo, bound outside of any vao to leave them untouched
+    glBindVertexArray(0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, _Indices.size()*sizeof(GLuint), _Indices.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    _IsUploaded = true;
+}
+
+void Geometry::bindAttributes() const {
+    if(!_IsUploaded){
+        fprintf(stderr, "Can't bind a geometry before sending it to the GPU!\n");
+        ErrorHandler::handle(ErrorCodes::NOT_INITALIZED);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, _VBO);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _EBO);
+
+    _Format.bindAttributes();
+}
+
+void Geometry::print(std::ostream& stream) const {
+    stream << "Vertices:\n";
+    for(GLuint i=0; i<_NbVertices; i++){
+        const GLfloat* vertex = &_VertexData[i*_NB_ELEMENT_PER_VERTICES];
+        stream << vertex[0] << " " << vertex[1] << " " << vertex[2] << "\n";
+    }
+
+    stream << "\nIndices:\n";
+    for(GLuint i=0; i<_NbIndices; i+=3){
+        stream << _Indices[i] << " " << _Indices[i+1] << " " << _Indices[i+2] << "\n";
+    }
+
+    stream << "\nUvs:\n";
+    for(GLuint i=0; i<_NbVertices; i++){
+        const GLfloat* vertex = &_VertexData[i*_NB_ELEMENT_PER_VERTICES];
+        stream << vertex[3] << " " << vertex[4] << "\n";
+    }
+
+    stream << "\nNormals:\n";
+    for(GLuint i=0; i<_NbVertices; i++){
+        const GLfloat* vertex = &_VertexData[i*_NB_ELEMENT_PER_VERTICES];
+        stream << vertex[5] << " " << vertex[6] << " " << vertex[7] << "\n";
+    }
+
+    stream << std::endl;
+}
@@ -0,0 +1,22 @@
+#include "gravityKernel.hpp"
+#include "gravityKernelImpl.hpp"
+
+void computeGravity(const GravityBatch& batch, GLfloat gravitationalConstant, GLfloat softening,
+                    GLuint first, GLuint last, SimdLevel level){
+    if(level > detectSimdLevel()) level = detectSimdLevel();
+    switch(level){
+        case SIMD_AVX2:
+            if(computeGravityAvx2(batch, gravitationalConstant, softening, first, last)) return;
+            // fall through
+        case SIMD_SSE:
+#ifdef SIMD_LANES_SSE
+            computeRange<SseLanes>(batch, gravitationalConstant, softening, first, last);
+            return;
+#endif
+            // fall through
+        case SIMD_SCALAR:
+        default:
+            computeRange<ScalarLanes>(batch, gravitationalConstant, softening, first, last);
+            return;
+    }
+}
@@ -0,0 +1,22 @@
+/**
+ * The kernel's functions are compiled with AVX2 and FMA enabled, the rest of the file targets every processor.
+ * Its code only runs once the processor has been checked
+*/
+#define SIMD_KERNEL_TARGET SIMD_AVX2_TARGET
+#include "gravityKernelImpl.hpp"
+
+#ifdef SIMD_LANES_AVX2
+
+bool computeGravityAvx2(const GravityBatch& batch, GLfloat gravitationalConstant, GLfloat softening, GLuint first, GLuint last){
+    computeRange<Avx2Lanes>(batch, gravitationalConstant, softening, first, last);
+    return true;
+}
+
+#else
+
+bool computeGravityAvx2(const GravityBatch& batch, GLfloat gravitationalConstant, GLfloat softening, GLuint first, GLuint last){
+    // built without AVX2 lanes, the dispatch falls back on the other ones
+    return false;
+}
+
+#endif
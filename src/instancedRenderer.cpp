@@ -0,0 +1,126 @@
+#include "instancedRenderer.hpp"
+#include <cstddef>
+#include <utility>
+
+InstancedRenderer::~InstancedRenderer(){
+    for(auto& batch : _Batches){
+        glDeleteVertexArrays(1, &batch._VAO);
+    }
+    glDeleteBuffers(1, &_InstanceVBO);
+}
+
+void InstancedRenderer::submit(const MeshPointer& mesh, const ShadersPointer& shader, GLuint texId, GLuint samplerId, const InstanceData& instance){
+    mesh->initGpuGeometry();
+    BatchKey key = BatchKey(mesh->getGeometry().get(), mesh->getColorStream(), shader.get(), texId, samplerId);
+    auto it = _BatchIndices.find(key);
+    size_t index = it != _BatchIndices.end() ? it->second : createBatch(mesh, shader, texId, samplerId);
+    _Batches[index]._Instances.push_back(instance);
+    // meshes without a color stream pass their constant color through the instance
+    _Batches[index]._Instances.back()._Color *= mesh->getConstantColor();
+}
+
+void InstancedRenderer::flush(){
+    // upload all the batches in one buffer
+    GLsizeiptr size = 0;
+    for(const auto& batch : _Batches){
+        size += batch._Instances.size()*sizeof(InstanceData);
+    }
+    if(size == 0){
+        removeEmptyBatches();
+        return;
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, _InstanceVBO);
+    // orphan the previous frame's storage
+    if(size > _Capacity) _Capacity = size;
+    glBufferData(GL_ARRAY_BUFFER, _Capacity, NULL, GL_STREAM_DRAW);
+
+    // the batches left empty this frame are removed once drawn, the meshes they hold are released
+    removeEmptyBatches();
+
+    GLsizeiptr offset = 0;
+    for(auto& batch : _Batches){
+        GLsizeiptr batchSize = batch._Instances.size()*sizeof(InstanceData);
+        glBufferSubData(GL_ARRAY_BUFFER, offset, batchSize, batch._Instances.data());
+
+        batch._Shader->use();
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, batch._TexId);
+        glBindSampler(0, batch._SamplerId);
+        glBindVertexArray(batch._VAO);
+        setInstanceAttributes(offset);
+        glVertexAttrib4f(VertexAttribute::VERTEX_COLOR, 1.0f, 1.0f, 1.0f, 1.0f);
+        glDrawElementsInstanced(GL_TRIANGLES, batch._Mesh->getNbIndices(), GL_UNSIGNED_INT, 0, batch._Instances.size());
+
+        offset += batchSize;
+        batch._Instances.clear();
+    }
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+size_t InstancedRenderer::createBatch(const MeshPointer& mesh, const ShadersPointer& shader, GLuint texId, GLuint samplerId){
+    InstanceBatch batch;
+    batch._Mesh = mesh;
+    batch._Shader = shader;
+    batch._TexId = texId;
+    batch._SamplerId = samplerId;
+
+    glGenVertexArrays(1, &batch._VAO);
+    glBindVertexArray(batch._VAO);
+    // per vertex attributes
+    mesh->bindAttributes();
+    // per instance attributes
+    glBindBuffer(GL_ARRAY_BUFFER, _InstanceVBO);
+    setInstanceAttributes(0);
+    for(GLuint i=InstanceAttribute::INSTANCE_MODEL; i<=InstanceAttribute::INSTANCE_USE_TEX; i++){
+        glEnableVertexAttribArray(i);
+        glVertexAttribDivisor(i, 1);
+    }
+    glBindVertexArray(0);
+
+    size_t index = _Batches.size();
+    _Batches.push_back(batch);
+    _BatchIndices[BatchKey(mesh->getGeometry().get(), mesh->getColorStream(), shader.get(), texId, samplerId)] = index;
+    return index;
+}
+
+void InstancedRenderer::removeEmptyBatches(){
+    // the new index of each batch, the number of batches for the removed ones
+    std::vector<size_t> indices(_Batches.size(), _Batches.size());
+    size_t nbKept = 0;
+    for(size_t i=0; i<_Batches.size(); i++){
+        if(_Batches[i]._Instances.empty()){
+            glDeleteVertexArrays(1, &_Batches[i]._VAO);
+            continue;
+        }
+        if(i != nbKept) _Batches[nbKept] = std::move(_Batches[i]);
+        indices[i] = nbKept++;
+    }
+    if(nbKept == _Batches.size()) return;
+
+    for(auto it = _BatchIndices.begin(); it != _BatchIndices.end();){
+        const size_t index = indices[it->second];
+        if(index == _Batches.size()){
+            it = _BatchIndices.erase(it);
+        } else {
+            it->second = index;
+            ++it;
+        }
+    }
+    _Batches.resize(nbKept);
+}
+
+void InstancedRenderer::setInstanceAttributes(GLsizeiptr offset) const {
+    const GLsizei stride = sizeof(InstanceData);
+    for(GLuint i=0; i<4; i++){
+        GLsizeiptr column = offset + offsetof(InstanceData, _Model) + i*sizeof(glm::vec4);
+        glVertexAttribPointer(InstanceAttribute::INSTANCE_MODEL+i, 4, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<GLvoid*>(column));
+    }
+    glVertexAttribPointer(InstanceAttribute::INSTANCE_COLOR, 4, GL_FLOAT, GL_FALSE, stride, 
+        reinterpret_cast<GLvoid*>(offset + offsetof(InstanceData, _Color)));
+    glVertexAttribPointer(InstanceAttribute::INSTANCE_MATERIAL, 4, GL_FLOAT, GL_FALSE, stride, 
+        reinterpret_cast<GLvoid*>(offset + offsetof(InstanceData, _Material)));
+    glVertexAttribPointer(InstanceAttribute::INSTANCE_USE_TEX, 1, GL_FLOAT, GL_FALSE, stride, 
+        reinterpret_cast<GLvoid*>(offset + offsetof(InstanceData, _UseTex)));
+}
@@ -0,0 +1,102 @@
+#include "jobSystem.hpp"
+#include <algorithm>
+
+JobSystemPointer JobSystem::_Instance = JobSystemPointer(nullptr);
+
+namespace {
+
+/**
+ * The queue index of the current thread, 0 for the threads outside of the pool
+*/
+thread_local GLuint tQueueIndex = 0;
+
+}
+
+JobSystem::JobSystem(GLuint nbWorkers){
+    for(GLuint i=0; i<=nbWorkers; i++){
+        _Queues.emplace_back(new JobQueue());
+    }
+    for(GLuint i=1; i<=nbWorkers; i++){
+        _Workers.emplace_back(&JobSystem::work, this, i);
+    }
+}
+
+JobSystem::~JobSystem(){
+    {
+        std::lock_guard<std::mutex> lock(_SleepMutex);
+        _IsStopping = true;
+    }
+    _WakeUp.notify_all();
+    for(auto& worker : _Workers){
+        worker.join();
+    }
+}
+
+bool JobSystem::take(GLuint index, Job& job){
+    if(_Queues[index]->pop(job)){
+        _NbPending--;
+        return true;
+    }
+    const GLuint nbQueues = _Queues.size();
+    for(GLuint i=1; i<nbQueues; i++){
+        if(_Queues[(index+i) % nbQueues]->steal(job)){
+            _NbPending--;
+            return true;
+        }
+    }
+    return false;
+}
+
+void JobSystem::submit(GLuint index, Job job){
+    _Queues[index]->push(std::move(job));
+    {
+        // taking the lock makes sure a worker about to sleep sees the new job
+        std::lock_guard<std::mutex> lock(_SleepMutex);
+        _NbPending++;
+    }
+    _WakeUp.notify_one();
+}
+
+void JobSystem::work(GLuint index){
+    tQueueIndex = index;
+    Job job;
+    while(true){
+        if(take(index, job)){
+            job();
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(_SleepMutex);
+        _WakeUp.wait(lock, [this](){ return _IsStopping || _NbPending > 0; });
+        if(_IsStopping) return;
+    }
+}
+
+void JobSystem::parallelFor(GLuint first, GLuint last, GLuint grain, const RangeJob& job){
+    if(first >= last) return;
+    grain = std::max(grain, 1u);
+    // not worth sharing
+    if(_Workers.empty() || last - first <= grain){
+        job(first, last);
+        return;
+    }
+
+    const GLuint index = tQueueIndex;
+    auto remaining = std::make_shared<std::atomic<GLuint>>((last - first + grain - 1) / grain);
+    // keep the first chunk for the calling thread
+    for(GLuint chunk=first+grain; chunk<last; chunk+=grain){
+        GLuint chunkLast = std::min(last, chunk + grain);
+        submit(index, [&job, chunk, chunkLast, remaining](){
+            job(chunk, chunkLast);
+            (*remaining)--;
+        });
+    }
+    job(first, std::min(last, first + grain));
+    (*remaining)--;
+
+    // help until every chunk is done
+    Job other;
+    while(*remaining > 0){
+        if(take(index, other)) other();
+        else std::this_thread::yield();
+    }
+}
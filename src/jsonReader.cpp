@@ -0,0 +1,219 @@
+#include "jsonReader.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+GLboolean JsonReader::open(const std::string& fileName){
+    FILE* file = fopen(fileName.c_str(), "rb");
+    if(!file) return false;
+    // a single allocation of the file's size, the parsing doesn't allocate anymore
+    fseek(file, 0, SEEK_END);
+    const long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    if(size < 0){
+        fclose(file);
+        return false;
+    }
+    _Text.resize(size);
+    const size_t read = fread(&_Text[0], 1, size, file);
+    fclose(file);
+    if(read != (size_t)size) return false;
+
+    _Cursor = _Text.c_str();
+    _End = _Cursor + _Text.size();
+    _Containers.clear();
+    _IsKeyExpected = false;
+    _IsSeparatorExpected = false;
+    _IsDone = false;
+    _Line = 1;
+    return true;
+}
+
+void JsonReader::skipWhitespace(){
+    while(_Cursor < _End){
+        const char c = *_Cursor;
+        if(c == '\n') _Line++;
+        else if(c != ' ' && c != '\t' && c != '\r') return;
+        _Cursor++;
+    }
+}
+
+GLboolean JsonReader::readString(){
+    _StringBegin = _Cursor;
+    _HasEscapes = false;
+    while(_Cursor < _End && *_Cursor != '"'){
+        if(*_Cursor == '\\'){
+            // the escaped character can't close the string
+            _HasEscapes = true;
+            _Cursor++;
+        } else if(*_Cursor == '\n'){
+            return false;
+        }
+        _Cursor++;
+    }
+    if(_Cursor >= _End) return false;
+    _StringEnd = _Cursor;
+    _Cursor++;
+    return true;
+}
+
+GLboolean JsonReader::readWord(const char* word){
+    const size_t length = strlen(word);
+    if((size_t)(_End - _Cursor) < length || strncmp(_Cursor, word, length) != 0) return false;
+    _Cursor += length;
+    return true;
+}
+
+void JsonReader::endValue(){
+    if(_Containers.empty()){
+        _IsDone = true;
+        return;
+    }
+    _IsSeparatorExpected = true;
+    _IsKeyExpected = _Containers.back() == '{';
+}
+
+JsonToken JsonReader::next(){
+    skipWhitespace();
+    if(_IsDone) return _Cursor == _End ? JSON_END : JSON_ERROR;
+    if(_Cursor >= _End) return JSON_ERROR;
+
+    // the values of a container are separated by commas, a comma can't come before its end
+    GLboolean isAfterComma = false;
+    if(_IsSeparatorExpected){
+        const char closing = _Containers.back() == '{' ? '}' : ']';
+        if(*_Cursor == ','){
+            _Cursor++;
+            skipWhitespace();
+            if(_Cursor >= _End) return JSON_ERROR;
+            isAfterComma = true;
+        } else if(*_Cursor != closing){
+            return JSON_ERROR;
+        }
+        _IsSeparatorExpected = false;
+    }
+
+    const char c = *_Cursor;
+    if(_IsKeyExpected && c != '"' && !(c == '}' && !isAfterComma)) return JSON_ERROR;
+    switch(c){
+        case '{':
+            _Cursor++;
+            _Containers.push_back('{');
+            _IsKeyExpected = true;
+            return JSON_OBJECT_BEGIN;
+        case '[':
+            _Cursor++;
+            _Containers.push_back('[');
+            _IsKeyExpected = false;
+            return JSON_ARRAY_BEGIN;
+        case '}':
+        case ']':{
+            const char opening = c == '}' ? '{' : '[';
+            if(isAfterComma || _Containers.empty() || _Containers.back() != opening) return JSON_ERROR;
+            _Cursor++;
+            _Containers.pop_back();
+            endValue();
+            return c == '}' ? JSON_OBJECT_END : JSON_ARRAY_END;
+        }
+        case '"':
+            _Cursor++;
+            if(!readString()) return JSON_ERROR;
+            if(_IsKeyExpected){
+                // the key's value follows its colon
+                skipWhitespace();
+                if(_Cursor >= _End || *_Cursor != ':') return JSON_ERROR;
+                _Cursor++;
+                _IsKeyExpected = false;
+                return JSON_KEY;
+            }
+            endValue();
+            return JSON_STRING;
+        case 't':
+        case 'f':
+            _Boolean = c == 't';
+            if(!readWord(_Boolean ? "true" : "false")) return JSON_ERROR;
+            endValue();
+            return JSON_BOOLEAN;
+        case 'n':
+            if(!readWord("null")) return JSON_ERROR;
+            endValue();
+            return JSON_NULL;
+        default:{
+            // the text ends with the string's terminator, strtod stops there at the latest
+            char* numberEnd = nullptr;
+            _Number = strtod(_Cursor, &numberEnd);
+            if(numberEnd == _Cursor) return JSON_ERROR;
+            _Cursor = numberEnd;
+            endValue();
+            return JSON_NUMBER;
+        }
+    }
+}
+
+GLboolean JsonReader::skipValue(){
+    GLuint depth = 0;
+    do{
+        switch(next()){
+            case JSON_OBJECT_BEGIN:
+            case JSON_ARRAY_BEGIN:
+                depth++;
+                break;
+            case JSON_OBJECT_END:
+            case JSON_ARRAY_END:
+                if(depth == 0) return false;
+                depth--;
+                break;
+            case JSON_END:
+            case JSON_ERROR:
+                return false;
+            default:
+                break;
+        }
+    } while(depth > 0);
+    return true;
+}
+
+GLboolean JsonReader::isString(const char* value) const {
+    if(_HasEscapes) return getString() == value;
+    const size_t length = _StringEnd - _StringBegin;
+    return strlen(value) == length && strncmp(_StringBegin, value, length) == 0;
+}
+
+std::string JsonReader::getString() const {
+    if(!_HasEscapes) return std::string(_StringBegin, _StringEnd);
+    std::string result;
+    result.reserve(_StringEnd - _StringBegin);
+    for(const char* c = _StringBegin; c < _StringEnd; c++){
+        if(*c != '\\' || c+1 >= _StringEnd){
+            result += *c;
+            continue;
+        }
+        c++;
+        switch(*c){
+            case 'n': result += '\n'; break;
+            case 't': result += '\t'; break;
+            case 'r': result += '\r'; break;
+            case 'b': result += '\b'; break;
+            case 'f': result += '\f'; break;
+            case 'u':{
+                // the code point, encoded in utf-8
+                if(_StringEnd - c < 5) return result;
+                const unsigned long code = strtoul(std::string(c+1, c+5).c_str(), nullptr, 16);
+                if(code < 0x80){
+                    result += (char)code;
+                } else if(code < 0x800){
+                    result += (char)(0xC0 | (code >> 6));
+                    result += (char)(0x80 | (code & 0x3F));
+                } else {
+                    result += (char)(0xE0 | (code >> 12));
+                    result += (char)(0x80 | ((code >> 6) & 0x3F));
+                    result += (char)(0x80 | (code & 0x3F));
+                }
+                c += 4;
+                break;
+            }
+            default: result += *c; break;
+        }
+    }
+    return result;
+}
@@ -5,39 +5,15 @@
 #include <GLFW/glfw3.h>
 #include <iostream>
 
-#include "entity.hpp"
-#include "material.hpp"
-#include "mesh.hpp"
 #include "shaders.hpp"
 #include "game.hpp"
 #include "scene.hpp"
+#include "sceneLoader.hpp"
 #include "camera.hpp"
-#include "planet.hpp"
-#include "sun.hpp"
+#include "errorHandler.hpp"
 
-// sun
-const static float kSizeSun = 1;
-const static glm::vec3 kSunRotationAxis = glm::vec3(0.f, 1.f, 0.f);
-const static float kSunRotationSpeed = 0.25f;
-
-// earth
-const static float kSizeEarth = 0.5;
-const static float kRadOrbitEarth = 10;
-const static float kEarthAngle = glm::radians(23.5f);
-const static glm::vec3 kEarthRotationAxis = glm::vec3(sin(kEarthAngle), cos(kEarthAngle), 0.f);
-const static glm::vec3 kEarthOrbitAxis = glm::vec3(0.f, 1.f, 0.f);
-
-// moon
-const static float kSizeMoon = 0.5;
-const static float kRadOrbitMoon = 2;
-const static glm::vec3 kMoonRotationAxis = glm::vec3(0.f, 1.f, 0.f);
-const static glm::vec3 kMoonOrbitAxis = glm::vec3(0.f, 1.f, 0.f);
-
-// speeds for orbital constraints
-const static float kEarthRotationSpeed = .05f; // fixed
-const static float kEarthOrbitSpeed = 2.0f*kRadOrbitEarth*kEarthRotationSpeed;
-const static float kMoonOrbitSpeed = 2.0f*kRadOrbitMoon*kEarthRotationSpeed;
-const static float kMoonRotationSpeed = 2.0f*kEarthRotationSpeed;
+// the scene loaded without a scene file on the command line
+const static std::string kDefaultSceneFile = "scenes/solarSystem.json";
 
 int main(int argc, char** argv){
     GLuint windowWidth  = 800;
@@ -46,39 +22,16 @@ int main(int argc, char** argv){
     GamePointer game = Game::init(windowWidth, windowHeight,"SolarSystem");
     ShadersPointer shader(new Shaders("shaders/vert.glsl", "shaders/frag.glsl"));
 
-    // setup the camera
+    // setup the camera, placed by the scene file
     CameraPointer camera(new Camera());
-    camera->setRatio(((GLfloat)windowWidth)/windowHeight);
-    camera->moveTo(glm::vec3(-2.0f, 5.0f, 25.f));
-    camera->setTarget(glm::vec3(-2.0f, .0f, 0.f));
-    
-    // setup the materials
-    MaterialPointer sunMaterial(new Material());
-    sunMaterial->setAmbient(1.0f);
-    MaterialPointer planetMaterial(new Material());
+    camera->setViewport(windowWidth, windowHeight);
 
     // create the scene
-    ScenePointer scene(new Scene(camera));
-
-    // setup the the sun
-    SunPointer sun(new Sun(sunMaterial, shader, glm::vec3(), glm::vec3(1.0,1.0,1.0)));
-    sun->getMesh()->setSimpleColor(glm::vec4(1.,1.,0.,1.));
-    sun->addToScene(scene);
-    sun->init(kSizeSun, kSunRotationSpeed, kSunRotationAxis);
-
-    // setup the earth
-    PlanetPointer earth(new Planet(planetMaterial, shader));
-    earth->getMesh()->setSimpleColor(glm::vec4(0.,1.,0.2,1.));
-    earth->init(kSizeEarth, kEarthRotationSpeed, kEarthRotationAxis, kEarthOrbitSpeed, kEarthOrbitAxis, kRadOrbitEarth, sun);
-    earth->addToScene(scene);
-    earth->loadTexture("media/earth.jpg");
-    
-    // setup the moon
-    PlanetPointer moon(new Planet(planetMaterial, shader));
-    moon->getMesh()->setSimpleColor(glm::vec4(1.,1.,1.,1.));
-    moon->init(kSizeMoon, kMoonRotationSpeed, kMoonRotationAxis, kMoonOrbitSpeed, kMoonOrbitAxis, kRadOrbitMoon, earth);
-    moon->addToScene(scene);
-    moon->loadTexture("media/moon.jpg");
+    ScenePointer scene = SceneLoader::load(argc > 1 ? argv[1] : kDefaultSceneFile, camera, shader);
+    if(!scene){
+        fprintf(stderr, "Failed to load the scene!\n");
+        ErrorHandler::handle(ErrorCodes::READ_FILE_ERROR);
+    }
 
     // main loop
     game->setClearColor(0.0f, 0.0f, 0.0f); // set a black background
@@ -87,4 +40,4 @@ int main(int argc, char** argv){
     game->quit();
 
     exit(EXIT_SUCCESS);
-}
\ No newline at end of file
+}
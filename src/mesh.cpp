@@ -1,6 +1,335 @@
 #include "mesh.hpp"
+#include <algorithm>
+#include <array>
+#include <unordered_map>
 
-const GLuint Mesh::_NB_ELEMENT_PER_VERTICES = VboType::VERTICES
-                                     + VboType::COLORS
-                                     + VboType::UVS
-                                     + VboType::NORMALS;
\ No newline at end of file
+namespace {
+
+/**
+ * Append a vertex of a sphere to a static stream
+ * @param vertexData The static stream
+ * @param direction The unit direction of the vertex from the center
+ * @param radius The sphere's radius
+ * @param center The sphere's center
+ * @return The index of the new vertex
+*/
+GLuint appendSphereVertex(Vbo& vertexData, const glm::vec3& direction, GLfloat radius, const glm::vec3& center){
+    const GLuint index = vertexData.size() / Geometry::_NB_ELEMENT_PER_VERTICES;
+    // same mapping as the uv sphere: theta = atan2(x, z), phi = acos(y)
+    GLfloat u = atan2(direction.x, direction.z) / (2.0f*M_PI);
+    if(u < 0.0f) u += 1.0f;
+    GLfloat v = acos(glm::clamp(direction.y, -1.0f, 1.0f)) / M_PI;
+    const GLfloat vertex[] = {
+        radius*direction.x + center.x, radius*direction.y + center.y, radius*direction.z + center.z,
+        u, v,
+        direction.x, direction.y, direction.z
+    };
+    vertexData.insert(vertexData.end(), vertex, vertex + Geometry::_NB_ELEMENT_PER_VERTICES);
+    return index;
+}
+
+/**
+ * Duplicate the vertices of the triangles crossing the texture seam or touching a pole
+ * so that the uvs interpolate correctly
+ * @param vertexData The static stream
+ * @param indices The triangle indices
+*/
+void fixSphereUvs(Vbo& vertexData, Indices& indices){
+    const GLuint stride = Geometry::_NB_ELEMENT_PER_VERTICES;
+    std::unordered_map<GLuint, GLuint> wrapped;
+    auto duplicate = [&vertexData, stride](GLuint index){
+        const GLuint newIndex = vertexData.size() / stride;
+        for(GLuint k=0; k<stride; k++) vertexData.push_back(vertexData[index*stride+k]);
+        return newIndex;
+    };
+    auto getU = [&vertexData, stride](GLuint index){ return vertexData[index*stride+3]; };
+    auto isPole = [&vertexData, stride](GLuint index){ return fabs(vertexData[index*stride+6]) > 0.9999f; };
+
+    for(size_t t=0; t<indices.size(); t+=3){
+        GLuint* triangle = &indices[t];
+        // the seam: move the vertices on the left of the texture to the right
+        GLfloat minU = 1.0f, maxU = 0.0f;
+        for(GLuint k=0; k<3; k++){
+            if(isPole(triangle[k])) continue;
+            minU = std::min(minU, getU(triangle[k]));
+            maxU = std::max(maxU, getU(triangle[k]));
+        }
+        if(maxU - minU > 0.5f){
+            for(GLuint k=0; k<3; k++){
+                if(isPole(triangle[k]) || getU(triangle[k]) >= 0.5f) continue;
+                auto it = wrapped.find(triangle[k]);
+                if(it == wrapped.end()){
+                    GLuint newIndex = duplicate(triangle[k]);
+                    vertexData[newIndex*stride+3] += 1.0f;
+                    it = wrapped.emplace(triangle[k], newIndex).first;
+                }
+                triangle[k] = it->second;
+            }
+        }
+        // the poles: give each triangle its own pole vertex in the middle of the other two
+        for(GLuint k=0; k<3; k++){
+            if(!isPole(triangle[k])) continue;
+            GLfloat u = 0.5f*(getU(triangle[(k+1)%3]) + getU(triangle[(k+2)%3]));
+            triangle[k] = duplicate(triangle[k]);
+            vertexData[triangle[k]*stride+3] = u;
+        }
+    }
+}
+
+/**
+ * Make a triangle face away from the sphere's center
+ * @param vertexData The static stream
+ * @param triangle The three indices of the triangle
+*/
+void orientOutward(const Vbo& vertexData, GLuint* triangle){
+    const GLuint stride = Geometry::_NB_ELEMENT_PER_VERTICES;
+    glm::vec3 p[3];
+    for(GLuint k=0; k<3; k++){
+        // use the normals so that the center of the sphere doesn't matter
+        const GLfloat* n = &vertexData[triangle[k]*stride+5];
+        p[k] = glm::vec3(n[0], n[1], n[2]);
+    }
+    if(glm::dot(glm::cross(p[1]-p[0], p[2]-p[0]), p[0]+p[1]+p[2]) < 0.0f){
+        std::swap(triangle[1], triangle[2]);
+    }
+}
+
+}
+
+MeshPointer Mesh::unitSphere(GLfloat radius, glm::vec3 center, GLuint resolution){
+    if(resolution<3){
+        fprintf(stderr, "The resolution of a sphere must be at least 3!\n");
+        ErrorHandler::handle(ErrorCodes::BAD_VALUE);
+    }
+
+    const GLuint nbRings = resolution + 1;
+    const GLuint nbSegments = resolution + 1;
+    const double stepPhi = M_PI / resolution;
+    const double stepTheta = 2.0 * M_PI / resolution;
+
+    // sin and cos tables, the rings are symmetric around the equator
+    std::vector<GLfloat> sinPhi(nbRings), cosPhi(nbRings);
+    for(GLuint i=0; i<=resolution/2; i++){
+        sinPhi[i] = sin(i*stepPhi);
+        cosPhi[i] = cos(i*stepPhi);
+        sinPhi[resolution-i] = sinPhi[i];
+        cosPhi[resolution-i] = -cosPhi[i];
+    }
+    std::vector<GLfloat> sinTheta(nbSegments), cosTheta(nbSegments);
+    for(GLuint j=0; j<nbSegments; j++){
+        sinTheta[j] = sin(j*stepTheta);
+        cosTheta[j] = cos(j*stepTheta);
+    }
+    // make the poles and the seam exact
+    sinPhi[0] = sinPhi[resolution] = 0.0f;
+    sinTheta[resolution] = sinTheta[0];
+    cosTheta[resolution] = cosTheta[0];
+
+    // generate the interleaved vertices directly, the normals are the unit directions
+    Vbo vertexData = Vbo(nbRings*nbSegments*Geometry::_NB_ELEMENT_PER_VERTICES);
+    GLfloat* vertex = vertexData.data();
+    for(GLuint i=0; i<nbRings; i++){
+        const GLfloat v = i / (GLfloat)resolution;
+        for(GLuint j=0; j<nbSegments; j++){
+            const GLfloat nx = sinTheta[j]*sinPhi[i];
+            const GLfloat ny = cosPhi[i];
+            const GLfloat nz = cosTheta[j]*sinPhi[i];
+            // position
+            vertex[0] = radius*nx + center.x;
+            vertex[1] = radius*ny + center.y;
+            vertex[2] = radius*nz + center.z;
+            // uv
+            vertex[3] = j / (GLfloat)resolution;
+            vertex[4] = v;
+            // normal
+            vertex[5] = nx;
+            vertex[6] = ny;
+            vertex[7] = nz;
+            vertex += Geometry::_NB_ELEMENT_PER_VERTICES;
+        }
+    }
+
+    // generate the indices, skipping the degenerate triangles at the poles
+    Indices indices = Indices(6*resolution*(resolution-1));
+    GLuint* index = indices.data();
+    for(GLuint i=0; i<resolution; i++){
+        for(GLuint j=0; j<resolution; j++){
+            const GLuint first = i * nbSegments + j;
+            const GLuint second = first + nbSegments;
+
+            if(i != 0){
+                index[0] = first;
+                index[1] = second;
+                index[2] = first + 1;
+                index += 3;
+            }
+            if(i != resolution-1){
+                index[0] = second;
+                index[1] = second + 1;
+                index[2] = first + 1;
+                index += 3;
+            }
+        }
+    }
+
+    GeometryPointer geometry = GeometryPointer(new Geometry(std::move(vertexData), std::move(indices), VertexFormat::packed()));
+    return MeshPointer(new Mesh(geometry));
+}
+
+MeshPointer Mesh::icoSphere(GLfloat radius, glm::vec3 center, GLuint resolution){
+    if(resolution<1){
+        fprintf(stderr, "The resolution of an icosphere must be at least 1!\n");
+        ErrorHandler::handle(ErrorCodes::BAD_VALUE);
+    }
+
+    // the icosahedron
+    const GLfloat t = (1.0f + sqrt(5.0f)) / 2.0f;
+    const std::array<glm::vec3, 12> corners = {
+        glm::vec3(-1, t, 0), glm::vec3(1, t, 0), glm::vec3(-1, -t, 0), glm::vec3(1, -t, 0),
+        glm::vec3(0, -1, t), glm::vec3(0, 1, t), glm::vec3(0, -1, -t), glm::vec3(0, 1, -t),
+        glm::vec3(t, 0, -1), glm::vec3(t, 0, 1), glm::vec3(-t, 0, -1), glm::vec3(-t, 0, 1),
+    };
+    const GLuint faces[20][3] = {
+        {0, 11, 5}, {0, 5, 1}, {0, 1, 7}, {0, 7, 10}, {0, 10, 11},
+        {1, 5, 9}, {5, 11, 4}, {11, 10, 2}, {10, 7, 6}, {7, 1, 8},
+        {3, 9, 4}, {3, 4, 2}, {3, 2, 6}, {3, 6, 8}, {3, 8, 9},
+        {4, 9, 5}, {2, 4, 11}, {6, 2, 10}, {8, 6, 7}, {9, 8, 1},
+    };
+
+    const GLuint n = resolution;
+    const GLuint nbVertices = 10*n*n + 2;
+    Vbo vertexData;
+    vertexData.reserve(nbVertices*Geometry::_NB_ELEMENT_PER_VERTICES);
+    Indices indices;
+    indices.reserve(20*n*n*3);
+
+    for(const auto& corner : corners){
+        appendSphereVertex(vertexData, glm::normalize(corner), radius, center);
+    }
+
+    // the vertices inside the edges, shared by the two faces of each edge
+    std::unordered_map<GLuint, std::vector<GLuint>> edges;
+    auto getEdge = [&](GLuint a, GLuint b){
+        const GLuint key = std::min(a, b)*12 + std::max(a, b);
+        auto it = edges.find(key);
+        if(it == edges.end()){
+            std::vector<GLuint> edge(n+1);
+            edge[0] = std::min(a, b);
+            edge[n] = std::max(a, b);
+            for(GLuint k=1; k<n; k++){
+                glm::vec3 point = glm::mix(corners[edge[0]], corners[edge[n]], k/(GLfloat)n);
+                edge[k] = appendSphereVertex(vertexData, glm::normalize(point), radius, center);
+            }
+            it = edges.emplace(key, edge).first;
+        }
+        // return the vertices going from a to b
+        std::vector<GLuint> edge = it->second;
+        if(a > b) std::reverse(edge.begin(), edge.end());
+        return edge;
+    };
+
+    for(const auto& face : faces){
+        // grid[i][j] is the vertex at a + i/n*(b-a) + j/n*(c-a)
+        std::vector<std::vector<GLuint>> grid(n+1);
+        std::vector<GLuint> ab = getEdge(face[0], face[1]);
+        std::vector<GLuint> ac = getEdge(face[0], face[2]);
+        std::vector<GLuint> bc = getEdge(face[1], face[2]);
+        const glm::vec3& a = corners[face[0]];
+        const glm::vec3& b = corners[face[1]];
+        const glm::vec3& c = corners[face[2]];
+        for(GLuint i=0; i<=n; i++){
+            grid[i].resize(n+1-i);
+            for(GLuint j=0; j<=n-i; j++){
+                if(j == 0) grid[i][j] = ab[i];
+                else if(i == 0) grid[i][j] = ac[j];
+                else if(i+j == n) grid[i][j] = bc[j];
+                else{
+                    glm::vec3 point = a + (b-a)*(i/(GLfloat)n) + (c-a)*(j/(GLfloat)n);
+                    grid[i][j] = appendSphereVertex(vertexData, glm::normalize(point), radius, center);
+                }
+            }
+        }
+        for(GLuint i=0; i<n; i++){
+            for(GLuint j=0; j<n-i; j++){
+                GLuint triangle[3] = {grid[i][j], grid[i+1][j], grid[i][j+1]};
+                orientOutward(vertexData, triangle);
+                indices.insert(indices.end(), triangle, triangle+3);
+                if(j+1 < n-i){
+                    GLuint other[3] = {grid[i+1][j], grid[i+1][j+1], grid[i][j+1]};
+                    orientOutward(vertexData, other);
+                    indices.insert(indices.end(), other, other+3);
+                }
+            }
+        }
+    }
+
+    fixSphereUvs(vertexData, indices);
+    GeometryPointer geometry = GeometryPointer(new Geometry(std::move(vertexData), std::move(indices), VertexFormat::packed()));
+    return MeshPointer(new Mesh(geometry));
+}
+
+MeshPointer Mesh::cubeSphere(GLfloat radius, glm::vec3 center, GLuint resolution){
+    if(resolution<1){
+        fprintf(stderr, "The resolution of a cube sphere must be at least 1!\n");
+        ErrorHandler::handle(ErrorCodes::BAD_VALUE);
+    }
+
+    // the normal and the two tangents of each face, with tangentU x tangentV = normal
+    const glm::vec3 normals[6] = {
+        glm::vec3(1, 0, 0), glm::vec3(-1, 0, 0), glm::vec3(0, 1, 0),
+        glm::vec3(0, -1, 0), glm::vec3(0, 0, 1), glm::vec3(0, 0, -1),
+    };
+    const glm::vec3 tangentsU[6] = {
+        glm::vec3(0, 1, 0), glm::vec3(0, 0, 1), glm::vec3(0, 0, 1),
+        glm::vec3(1, 0, 0), glm::vec3(1, 0, 0), glm::vec3(0, 1, 0),
+    };
+
+    const GLuint n = resolution;
+    const GLuint nbSide = n + 1;
+    Vbo vertexData;
+    vertexData.reserve(6*nbSide*nbSide*Geometry::_NB_ELEMENT_PER_VERTICES);
+    Indices indices;
+    indices.reserve(6*n*n*6);
+
+    for(GLuint face=0; face<6; face++){
+        const glm::vec3 tangentV = glm::cross(normals[face], tangentsU[face]);
+        const GLuint first = vertexData.size() / Geometry::_NB_ELEMENT_PER_VERTICES;
+        for(GLuint i=0; i<=n; i++){
+            for(GLuint j=0; j<=n; j++){
+                glm::vec3 p = normals[face] + tangentsU[face]*(2.0f*i/n - 1.0f) + tangentV*(2.0f*j/n - 1.0f);
+                // spherified cube mapping, more uniform than a plain normalization
+                const glm::vec3 p2 = p*p;
+                glm::vec3 direction = glm::vec3(
+                    p.x*sqrt(1.0f - p2.y/2.0f - p2.z/2.0f + p2.y*p2.z/3.0f),
+                    p.y*sqrt(1.0f - p2.z/2.0f - p2.x/2.0f + p2.z*p2.x/3.0f),
+                    p.z*sqrt(1.0f - p2.x/2.0f - p2.y/2.0f + p2.x*p2.y/3.0f)
+                );
+                appendSphereVertex(vertexData, glm::normalize(direction), radius, center);
+            }
+        }
+        for(GLuint i=0; i<n; i++){
+            for(GLuint j=0; j<n; j++){
+                const GLuint a = first + i*nbSide + j;
+                const GLuint b = a + nbSide;
+                const GLuint quad[6] = {a, b, a+1, b, b+1, a+1};
+                indices.insert(indices.end(), quad, quad+6);
+            }
+        }
+    }
+
+    fixSphereUvs(vertexData, indices);
+    GeometryPointer geometry = GeometryPointer(new Geometry(std::move(vertexData), std::move(indices), VertexFormat::packed()));
+    return MeshPointer(new Mesh(geometry));
+}
+
+MeshPointer Mesh::sphere(SphereType type, GLfloat radius, glm::vec3 center, GLuint resolution){
+    switch(type){
+        case ICO_SPHERE:
+            return icoSphere(radius, center, resolution);
+        case CUBE_SPHERE:
+            return cubeSphere(radius, center, resolution);
+        case UV_SPHERE:
+        default:
+            return unitSphere(radius, center, resolution);
+    }
+}
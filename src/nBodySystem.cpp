@@ -0,0 +1,207 @@
+#include "nBodySystem.hpp"
+#include "errorHandler.hpp"
+#include "gravityKernel.hpp"
+#include "jobSystem.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+
+namespace {
+
+/**
+ * The number of particles whose exact forces are computed by a job
+*/
+const static GLuint kDirectParticlesPerJob = 256;
+
+}
+
+GLuint NBodySystem::add(const glm::dvec3& position, const glm::dvec3& velocity, GLfloat mass, BodyHandle body){
+    if(mass < 0.0f){
+        fprintf(stderr, "A particle can't have a negative mass!\n");
+        ErrorHandler::handle(ErrorCodes::BAD_VALUE, ErrorLevel::WARNING);
+        mass = 0.0f;
+    }
+    if(body != kInvalidBody){
+        auto driver = _Particles.find(body);
+        if(driver != _Particles.end()){
+            fprintf(stderr, "A particle already drives the body %d, the new one takes over!\n", body);
+            ErrorHandler::handle(ErrorCodes::BAD_VALUE, ErrorLevel::WARNING);
+            _Bodies[driver->second] = kInvalidBody;
+        }
+        _Particles[body] = _Masses.size();
+    }
+    _Bodies.push_back(body);
+    _PositionsX.push_back(position.x);
+    _PositionsY.push_back(position.y);
+    _PositionsZ.push_back(position.z);
+    _RelativePositionsX.push_back(0.0f);
+    _RelativePositionsY.push_back(0.0f);
+    _RelativePositionsZ.push_back(0.0f);
+    _VelocitiesX.push_back(velocity.x);
+    _VelocitiesY.push_back(velocity.y);
+    _VelocitiesZ.push_back(velocity.z);
+    _AccelerationsX.push_back(0.0f);
+    _AccelerationsY.push_back(0.0f);
+    _AccelerationsZ.push_back(0.0f);
+    _Masses.push_back(mass);
+    _AreAccelerationsValid = false;
+    return _Masses.size() - 1;
+}
+
+void NBodySystem::remove(BodyHandle body){
+    auto driver = _Particles.find(body);
+    if(driver == _Particles.end()){
+        fprintf(stderr, "No particle drives the body %d!\n", body);
+        ErrorHandler::handle(ErrorCodes::OUT_OF_RANGE, ErrorLevel::WARNING);
+        return;
+    }
+    const GLuint index = driver->second;
+    _Particles.erase(driver);
+    // move the last particle in the hole
+    const GLuint last = _Bodies.size()-1;
+    if(index != last && _Bodies[last] != kInvalidBody) _Particles[_Bodies[last]] = index;
+    auto moveLast = [index, last](auto& values){
+        values[index] = values[last];
+        values.pop_back();
+    };
+    moveLast(_Bodies);
+    moveLast(_PositionsX);
+    moveLast(_PositionsY);
+    moveLast(_PositionsZ);
+    moveLast(_RelativePositionsX);
+    moveLast(_RelativePositionsY);
+    moveLast(_RelativePositionsZ);
+    moveLast(_VelocitiesX);
+    moveLast(_VelocitiesY);
+    moveLast(_VelocitiesZ);
+    moveLast(_AccelerationsX);
+    moveLast(_AccelerationsY);
+    moveLast(_AccelerationsZ);
+    moveLast(_Masses);
+    _AreAccelerationsValid = false;
+}
+
+void NBodySystem::setSoftening(GLfloat softening){
+    if(softening <= 0.0f){
+        fprintf(stderr, "The softening length must be positive!\n");
+        ErrorHandler::handle(ErrorCodes::BAD_VALUE, ErrorLevel::WARNING);
+        return;
+    }
+    _Softening = softening;
+    _AreAccelerationsValid = false;
+}
+
+void NBodySystem::computeAccelerations(){
+    const GLuint nbParticles = getNbParticles();
+    if(nbParticles == 0) return;
+    // the forces only depend on the differences, small near the first particle even far from the origin
+    const GLdouble originX = _PositionsX[0], originY = _PositionsY[0], originZ = _PositionsZ[0];
+    for(GLuint i=0; i<nbParticles; i++){
+        _RelativePositionsX[i] = (GLfloat)(_PositionsX[i] - originX);
+        _RelativePositionsY[i] = (GLfloat)(_PositionsY[i] - originY);
+        _RelativePositionsZ[i] = (GLfloat)(_PositionsZ[i] - originZ);
+    }
+    if(_Solver == GRAVITY_DIRECT || (_Solver == GRAVITY_AUTO && nbParticles < kDirectGravityLimit)){
+        GravityBatch batch;
+        batch._NbBodies = nbParticles;
+        batch._X = _RelativePositionsX.data();
+        batch._Y = _RelativePositionsY.data();
+        batch._Z = _RelativePositionsZ.data();
+        batch._Masses = _Masses.data();
+        batch._AccelerationsX = _AccelerationsX.data();
+        batch._AccelerationsY = _AccelerationsY.data();
+        batch._AccelerationsZ = _AccelerationsZ.data();
+        JobSystem::getInstance()->parallelFor(0, nbParticles, kDirectParticlesPerJob, [this, &batch](GLuint first, GLuint last){
+            computeGravity(batch, _GravitationalConstant, _Softening, first, last);
+        });
+        _AreAccelerationsValid = true;
+        return;
+    }
+    _Tree.build(_RelativePositionsX.data(), _RelativePositionsY.data(), _RelativePositionsZ.data(), _Masses.data(), nbParticles);
+    _Tree.computeAccelerations(_GravitationalConstant, _Softening, _OpeningAngle,
+                                _AccelerationsX.data(), _AccelerationsY.data(), _AccelerationsZ.data());
+    _AreAccelerationsValid = true;
+}
+
+void NBodySystem::integrate(GLfloat dt){
+    const GLuint nbParticles = getNbParticles();
+    if(!_AreAccelerationsValid) computeAccelerations();
+
+    // half kick and drift, then half kick with the new forces: symplectic, the energy doesn't drift
+    const GLdouble halfDt = 0.5 * dt;
+    for(GLuint i=0; i<nbParticles; i++){
+        _VelocitiesX[i] += halfDt * _AccelerationsX[i];
+        _VelocitiesY[i] += halfDt * _AccelerationsY[i];
+        _VelocitiesZ[i] += halfDt * _AccelerationsZ[i];
+        _PositionsX[i] += dt * _VelocitiesX[i];
+        _PositionsY[i] += dt * _VelocitiesY[i];
+        _PositionsZ[i] += dt * _VelocitiesZ[i];
+    }
+    computeAccelerations();
+    for(GLuint i=0; i<nbParticles; i++){
+        _VelocitiesX[i] += halfDt * _AccelerationsX[i];
+        _VelocitiesY[i] += halfDt * _AccelerationsY[i];
+        _VelocitiesZ[i] += halfDt * _AccelerationsZ[i];
+    }
+}
+
+void NBodySystem::moveBodies() const {
+    BodyStorePointer store = BodyStore::getInstance();
+    for(GLuint i=0; i<getNbParticles(); i++){
+        if(_Bodies[i] != kInvalidBody) store->moveTo(_Bodies[i], getPosition(i));
+    }
+}
+
+GLdouble NBodySystem::getAccurateStep() const {
+    // the softening is the shortest length resolved, a step must not cross it under the strongest pull
+    GLfloat maxAcceleration2 = 0.0f;
+    for(GLuint i=0; i<getNbParticles(); i++){
+        const GLfloat acceleration2 = _AccelerationsX[i]*_AccelerationsX[i] + _AccelerationsY[i]*_AccelerationsY[i] + _AccelerationsZ[i]*_AccelerationsZ[i];
+        maxAcceleration2 = std::max(maxAcceleration2, acceleration2);
+    }
+    if(maxAcceleration2 <= 0.0f) return std::numeric_limits<GLdouble>::infinity();
+    return _StepAccuracy * std::sqrt(_Softening / std::sqrt(maxAcceleration2));
+}
+
+void NBodySystem::step(GLfloat dt){
+    if(getNbParticles() == 0) return;
+    integrate(dt);
+    moveBodies();
+}
+
+void NBodySystem::advance(GLdouble duration, GLdouble budget){
+    _IsDegraded = false;
+    if(getNbParticles() == 0 || duration <= 0.0) return;
+    if(!_AreAccelerationsValid) computeAccelerations();
+
+    const auto start = std::chrono::steady_clock::now();
+    GLdouble remaining = duration;
+    while(remaining > 0.0){
+        const GLdouble elapsed = std::chrono::duration<GLdouble>(std::chrono::steady_clock::now() - start).count();
+        if(remaining < duration && elapsed >= budget){
+            // a single huge step would throw the particles off their orbits, they rather fall behind the clock
+            _Lag += remaining;
+            _IsDegraded = true;
+            break;
+        }
+        // the steps adapt to the strongest pull, which changes as the particles move
+        const GLdouble accurateStep = getAccurateStep();
+        GLdouble dt = std::min(remaining, accurateStep);
+        if(_StepCost > 0.0 && remaining > dt){
+            // spread the rest over the steps that still fit in the budget, at least one, never too long
+            const GLdouble affordable = std::max(1.0, std::floor((budget - elapsed) / _StepCost));
+            if(std::ceil(remaining / dt) > affordable){
+                dt = std::min(remaining / affordable, kMaxStepStretch * accurateStep);
+                _IsDegraded = true;
+            }
+        }
+        const auto stepStart = std::chrono::steady_clock::now();
+        integrate(dt);
+        _StepCost = std::chrono::duration<GLdouble>(std::chrono::steady_clock::now() - stepStart).count();
+        remaining -= dt;
+        // the rounding of the last spread step
+        if(remaining <= duration * 1e-9) break;
+    }
+    moveBodies();
+}
@@ -0,0 +1,225 @@
+#include "octree.hpp"
+#include "jobSystem.hpp"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace {
+
+/**
+ * The number of bits of each coordinate in the Morton codes, also the maximal depth of the tree.
+ * The cells are then finer than the floats of most particles, the leaves stay small in the densest clusters
+*/
+const static GLuint kMortonBits = 21;
+
+/**
+ * The number of particles whose forces are computed by a job
+*/
+const static GLuint kParticlesPerJob = 256;
+
+/**
+ * Spread the bits of a coordinate two bits apart
+ * @param cell The coordinate, on kMortonBits bits
+ * @return The bits, interleaved with zeros
+*/
+std::uint64_t spreadBits(GLuint cell){
+    std::uint64_t value = cell;
+    value = (value | (value << 32)) & 0x001F00000000FFFFull;
+    value = (value | (value << 16)) & 0x001F0000FF0000FFull;
+    value = (value | (value << 8)) & 0x100F00F00F00F00Full;
+    value = (value | (value << 4)) & 0x10C30C30C30C30C3ull;
+    value = (value | (value << 2)) & 0x1249249249249249ull;
+    return value;
+}
+
+}
+
+void Octree::build(const GLfloat* x, const GLfloat* y, const GLfloat* z, const GLfloat* masses, GLuint nbParticles){
+    _Nodes.clear();
+    if(nbParticles == 0) return;
+
+    _Order.resize(nbParticles);
+    _Codes.resize(nbParticles);
+    _X.assign(x, x + nbParticles);
+    _Y.assign(y, y + nbParticles);
+    _Z.assign(z, z + nbParticles);
+    _Masses.assign(masses, masses + nbParticles);
+    for(GLuint i=0; i<nbParticles; i++){
+        _Order[i] = i;
+    }
+    const GLfloat size = sortAlongCurve(0, nbParticles);
+
+    // about two nodes per leaf
+    _Nodes.reserve(2 * nbParticles / kOctreeLeafSize + 1);
+    buildNode(0, nbParticles, 0, size);
+}
+
+GLfloat Octree::sortAlongCurve(GLuint first, GLuint last){
+    // the cube bounding the particles
+    GLfloat minX = _X[first], minY = _Y[first], minZ = _Z[first];
+    GLfloat maxX = _X[first], maxY = _Y[first], maxZ = _Z[first];
+    for(GLuint i=first+1; i<last; i++){
+        minX = std::min(minX, _X[i]);
+        minY = std::min(minY, _Y[i]);
+        minZ = std::min(minZ, _Z[i]);
+        maxX = std::max(maxX, _X[i]);
+        maxY = std::max(maxY, _Y[i]);
+        maxZ = std::max(maxZ, _Z[i]);
+    }
+    // slightly larger so that the farthest particles stay in the last cell
+    const GLfloat size = std::max(std::max(maxX - minX, maxY - minY), maxZ - minZ) * 1.0001f;
+    const GLfloat scale = (GLfloat)(1u << kMortonBits) / size;
+    if(!(size > 0.0f) || !std::isfinite(scale)){
+        std::fill(_Codes.begin() + first, _Codes.begin() + last, 0);
+        return 0.0f;
+    }
+
+    const GLuint nbParticles = last - first;
+    std::vector<std::pair<std::uint64_t, GLuint>> keys(nbParticles);
+    for(GLuint i=0; i<nbParticles; i++){
+        const GLuint maxCell = (1u << kMortonBits) - 1;
+        const GLuint particle = first + i;
+        GLuint cellX = std::min(maxCell, (GLuint)((_X[particle] - minX) * scale));
+        GLuint cellY = std::min(maxCell, (GLuint)((_Y[particle] - minY) * scale));
+        GLuint cellZ = std::min(maxCell, (GLuint)((_Z[particle] - minZ) * scale));
+        keys[i] = {(spreadBits(cellX) << 2) | (spreadBits(cellY) << 1) | spreadBits(cellZ), particle};
+    }
+    std::sort(keys.begin(), keys.end());
+
+    // the range is moved in its new order
+    const std::vector<GLuint> order(_Order.begin() + first, _Order.begin() + last);
+    const std::vector<GLfloat> x(_X.begin() + first, _X.begin() + last);
+    const std::vector<GLfloat> y(_Y.begin() + first, _Y.begin() + last);
+    const std::vector<GLfloat> z(_Z.begin() + first, _Z.begin() + last);
+    const std::vector<GLfloat> masses(_Masses.begin() + first, _Masses.begin() + last);
+    for(GLuint i=0; i<nbParticles; i++){
+        const GLuint previous = keys[i].second - first;
+        _Codes[first + i] = keys[i].first;
+        _Order[first + i] = order[previous];
+        _X[first + i] = x[previous];
+        _Y[first + i] = y[previous];
+        _Z[first + i] = z[previous];
+        _Masses[first + i] = masses[previous];
+    }
+    return size;
+}
+
+void Octree::buildNode(GLuint first, GLuint last, GLuint level, GLfloat size){
+    const GLuint index = _Nodes.size();
+    OctreeNode node = {};
+    node._Size = size;
+    node._First = first;
+    node._Last = last;
+    node._IsLeaf = last - first <= kOctreeLeafSize || size == 0.0f;
+    GLfloat childSize = 0.5f * size;
+    if(!node._IsLeaf && level >= kMortonBits){
+        // the finest cells can't split the particles, they are sorted again in the smaller cube bounding them
+        childSize = 0.5f * sortAlongCurve(first, last);
+        node._IsLeaf = childSize == 0.0f;
+        level = 0;
+    }
+    _Nodes.push_back(node);
+
+    GLdouble mass = 0.0, centerX = 0.0, centerY = 0.0, centerZ = 0.0;
+    if(_Nodes[index]._IsLeaf){
+        for(GLuint i=first; i<last; i++){
+            mass += _Masses[i];
+            centerX += _Masses[i] * _X[i];
+            centerY += _Masses[i] * _Y[i];
+            centerZ += _Masses[i] * _Z[i];
+        }
+    } else {
+        // the particles of each child cube are consecutive, the children are created in order
+        const GLuint shift = 3 * (kMortonBits - 1 - level);
+        GLuint i = first;
+        while(i < last){
+            const GLuint octant = (_Codes[i] >> shift) & 7;
+            GLuint j = i + 1;
+            while(j < last && ((_Codes[j] >> shift) & 7) == octant) j++;
+            const GLuint child = _Nodes.size();
+            buildNode(i, j, level + 1, childSize);
+            const OctreeNode& childNode = _Nodes[child];
+            mass += childNode._Mass;
+            centerX += (GLdouble)childNode._Mass * childNode._CenterX;
+            centerY += (GLdouble)childNode._Mass * childNode._CenterY;
+            centerZ += (GLdouble)childNode._Mass * childNode._CenterZ;
+            i = j;
+        }
+    }
+
+    OctreeNode& result = _Nodes[index];
+    result._Mass = mass;
+    if(mass > 0.0){
+        result._CenterX = centerX / mass;
+        result._CenterY = centerY / mass;
+        result._CenterZ = centerZ / mass;
+    } else {
+        // massless particles pull nothing, any point of the node will do
+        result._CenterX = _X[first];
+        result._CenterY = _Y[first];
+        result._CenterZ = _Z[first];
+    }
+    result._Next = _Nodes.size();
+}
+
+void Octree::computeAccelerations(GLfloat gravitationalConstant, GLfloat softening, GLfloat openingAngle,
+                                    GLfloat* ax, GLfloat* ay, GLfloat* az){
+    const GLuint nbParticles = _Order.size();
+    if(_Nodes.empty()) return;
+    _AccelerationsX.resize(nbParticles);
+    _AccelerationsY.resize(nbParticles);
+    _AccelerationsZ.resize(nbParticles);
+    const GLfloat softening2 = softening * softening;
+    const GLfloat openingAngle2 = openingAngle * openingAngle;
+
+    // neighbouring particles walk the same nodes, the jobs follow the Morton order
+    JobSystem::getInstance()->parallelFor(0, nbParticles, kParticlesPerJob, [this, softening2, openingAngle2](GLuint first, GLuint last){
+        const GLuint nbNodes = _Nodes.size();
+        for(GLuint i=first; i<last; i++){
+            const GLfloat x = _X[i], y = _Y[i], z = _Z[i];
+            GLfloat accelerationX = 0.0f, accelerationY = 0.0f, accelerationZ = 0.0f;
+            GLuint n = 0;
+            while(n < nbNodes){
+                const OctreeNode& node = _Nodes[n];
+                const GLfloat dx = node._CenterX - x;
+                const GLfloat dy = node._CenterY - y;
+                const GLfloat dz = node._CenterZ - z;
+                const GLfloat distance2 = dx*dx + dy*dy + dz*dz;
+                if(node._IsLeaf){
+                    // the particle itself is at a zero distance and adds nothing
+                    for(GLuint j=node._First; j<node._Last; j++){
+                        const GLfloat px = _X[j] - x, py = _Y[j] - y, pz = _Z[j] - z;
+                        const GLfloat r2 = px*px + py*py + pz*pz + softening2;
+                        if(r2 <= 0.0f) continue;
+                        const GLfloat strength = _Masses[j] / (r2 * std::sqrt(r2));
+                        accelerationX += strength * px;
+                        accelerationY += strength * py;
+                        accelerationZ += strength * pz;
+                    }
+                    n = node._Next;
+                } else if(node._Size * node._Size < openingAngle2 * distance2){
+                    // far enough, the whole node pulls from its center of mass
+                    const GLfloat r2 = distance2 + softening2;
+                    const GLfloat strength = node._Mass / (r2 * std::sqrt(r2));
+                    accelerationX += strength * dx;
+                    accelerationY += strength * dy;
+                    accelerationZ += strength * dz;
+                    n = node._Next;
+                } else {
+                    // open the node, its first child follows it
+                    n++;
+                }
+            }
+            _AccelerationsX[i] = accelerationX;
+            _AccelerationsY[i] = accelerationY;
+            _AccelerationsZ[i] = accelerationZ;
+        }
+    });
+
+    for(GLuint i=0; i<nbParticles; i++){
+        const GLuint particle = _Order[i];
+        ax[particle] = gravitationalConstant * _AccelerationsX[i];
+        ay[particle] = gravitationalConstant * _AccelerationsY[i];
+        az[particle] = gravitationalConstant * _AccelerationsZ[i];
+    }
+}
@@ -1,4 +1,4 @@
 #include "planet.hpp"
 #include "mesh.hpp"
 
-MeshPointer Planet::_SphereMesh = nullptr;
\ No newline at end of file
+std::weak_ptr<LodChain> Planet::_SphereLods;
\ No newline at end of file
@@ -0,0 +1,116 @@
+#include "sceneGraph.hpp"
+#include "entity.hpp"
+#include "errorHandler.hpp"
+#include "jobSystem.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace {
+
+/**
+ * The number of entities updated by a job
+*/
+const static GLuint kNodesPerJob = 1024;
+
+}
+
+void SceneGraph::build(const GraphNodes& allEntities){
+    // the store updates its bodies, the graph only needs their frames for the entities out of it
+    std::unordered_set<const Entity*> needed;
+    for(const Entity* entity : allEntities){
+        if(entity->isInStore()) continue;
+        for(const Entity* node = entity; node && needed.insert(node).second; node = node->getParent());
+    }
+    GraphNodes entities;
+    entities.reserve(needed.size());
+    for(Entity* entity : allEntities){
+        if(needed.count(entity)) entities.push_back(entity);
+    }
+
+    const GLuint nbNodes = entities.size();
+    std::unordered_map<const Entity*, GLuint> indices;
+    indices.reserve(nbNodes);
+    for(GLuint i=0; i<nbNodes; i++){
+        indices[entities[i]] = i;
+    }
+
+    // the parent of each entity, in the given order
+    std::vector<GLint> parents(nbNodes, -1);
+    _IsMissingParents = false;
+    for(GLuint i=0; i<nbNodes; i++){
+        const Entity* parent = entities[i]->getParent();
+        if(parent == nullptr) continue;
+        auto it = indices.find(parent);
+        if(it == indices.end()){
+            fprintf(stderr, "The parent of an entity must be in the same scene! The entity is updated as a root.\n");
+            ErrorHandler::handle(ErrorCodes::NOT_INITALIZED, ErrorLevel::WARNING);
+            _IsMissingParents = true;
+            continue;
+        }
+        parents[i] = it->second;
+    }
+
+    // the depth of each entity, following the parents until a known depth
+    std::vector<GLint> depths(nbNodes, -1);
+    std::vector<GLuint> chain;
+    GLint maxDepth = -1;
+    for(GLuint i=0; i<nbNodes; i++){
+        GLint node = i;
+        chain.clear();
+        while(node >= 0 && depths[node] < 0){
+            chain.push_back(node);
+            if(chain.size() > nbNodes){
+                fprintf(stderr, "The entities' hierarchy contains a cycle!\n");
+                ErrorHandler::handle(ErrorCodes::BAD_VALUE);
+                return;
+            }
+            node = parents[node];
+        }
+        GLint depth = node >= 0 ? depths[node] : -1;
+        for(auto it = chain.rbegin(); it != chain.rend(); it++){
+            depths[*it] = ++depth;
+        }
+        maxDepth = std::max(maxDepth, depths[i]);
+    }
+
+    // counting sort by depth, keeping the given order inside a level
+    _Levels.assign(maxDepth+2, 0);
+    for(GLuint i=0; i<nbNodes; i++){
+        _Levels[depths[i]+1]++;
+    }
+    for(GLuint level=1; level<_Levels.size(); level++){
+        _Levels[level] += _Levels[level-1];
+    }
+    std::vector<GLuint> order(nbNodes);
+    std::vector<GLuint> sorted(nbNodes);
+    GraphLevels next(_Levels.begin(), _Levels.end()-1);
+    for(GLuint i=0; i<nbNodes; i++){
+        order[i] = next[depths[i]]++;
+        sorted[order[i]] = i;
+    }
+
+    _Nodes.resize(nbNodes);
+    _Parents.resize(nbNodes);
+    _Frames.assign(nbNodes, glm::mat4(1.0f));
+    for(GLuint i=0; i<nbNodes; i++){
+        GLuint original = sorted[i];
+        _Nodes[i] = entities[original];
+        _Parents[i] = parents[original] >= 0 ? (GLint)order[parents[original]] : -1;
+    }
+}
+
+void SceneGraph::update(GLdouble time){
+    const glm::mat4 identity = glm::mat4(1.0f);
+    JobSystemPointer jobs = JobSystem::getInstance();
+    // the nodes of a depth only depend on the previous depths
+    for(GLuint level=0; level+1<_Levels.size(); level++){
+        jobs->parallelFor(_Levels[level], _Levels[level+1], kNodesPerJob, [this, &identity, time](GLuint first, GLuint last){
+            for(GLuint i=first; i<last; i++){
+                const GLint parent = _Parents[i];
+                _Frames[i] = _Nodes[i]->updateTransform(time, parent >= 0 ? _Frames[parent] : identity);
+            }
+        });
+    }
+}
@@ -0,0 +1,305 @@
+#include "sceneLoader.hpp"
+#include "ephemeris.hpp"
+#include "errorHandler.hpp"
+#include "sun.hpp"
+#include <cstdio>
+
+GLboolean SceneLoader::fail(const char* message){
+    fprintf(stderr, "%s:%u: %s!\n", _FileName.c_str(), _Reader.getLine(), message);
+    return false;
+}
+
+template <typename ReadValue>
+GLboolean SceneLoader::readObject(ReadValue readValue){
+    if(_Reader.next() != JSON_OBJECT_BEGIN) return fail("An object is expected");
+    return readMembers(readValue);
+}
+
+template <typename ReadValue>
+GLboolean SceneLoader::readMembers(ReadValue readValue){
+    while(true){
+        switch(_Reader.next()){
+            case JSON_OBJECT_END:
+                return true;
+            case JSON_KEY:
+                if(!readValue()) return false;
+                break;
+            default:
+                return fail("A key is expected");
+        }
+    }
+}
+
+GLboolean SceneLoader::readNumber(GLdouble& value){
+    if(_Reader.next() != JSON_NUMBER) return fail("A number is expected");
+    value = _Reader.getNumber();
+    return true;
+}
+
+GLboolean SceneLoader::readNumber(GLfloat& value){
+    GLdouble number = 0.0;
+    if(!readNumber(number)) return false;
+    value = (GLfloat)number;
+    return true;
+}
+
+GLboolean SceneLoader::readString(std::string& value){
+    if(_Reader.next() != JSON_STRING) return fail("A string is expected");
+    value = _Reader.getString();
+    return true;
+}
+
+GLboolean SceneLoader::readNumbers(GLdouble* values, GLuint size){
+    if(_Reader.next() != JSON_ARRAY_BEGIN) return fail("An array is expected");
+    for(GLuint i=0; i<size; i++){
+        if(_Reader.next() != JSON_NUMBER) return fail("An array of numbers is expected");
+        values[i] = _Reader.getNumber();
+    }
+    if(_Reader.next() != JSON_ARRAY_END) return fail("The array is too long");
+    return true;
+}
+
+GLboolean SceneLoader::readVector(glm::vec3& value){
+    GLdouble values[3];
+    if(!readNumbers(values, 3)) return false;
+    value = glm::vec3(values[0], values[1], values[2]);
+    return true;
+}
+
+GLboolean SceneLoader::readVector(glm::dvec3& value){
+    GLdouble values[3];
+    if(!readNumbers(values, 3)) return false;
+    value = glm::dvec3(values[0], values[1], values[2]);
+    return true;
+}
+
+GLboolean SceneLoader::readVector(glm::vec4& value){
+    GLdouble values[4];
+    if(!readNumbers(values, 4)) return false;
+    value = glm::vec4(values[0], values[1], values[2], values[3]);
+    return true;
+}
+
+GLboolean SceneLoader::readCamera(const CameraPointer& camera){
+    return readObject([this, &camera]() -> GLboolean {
+        glm::dvec3 value;
+        if(_Reader.isString("position")){
+            if(!readVector(value)) return false;
+            camera->moveTo(value);
+            return true;
+        }
+        if(_Reader.isString("target")){
+            if(!readVector(value)) return false;
+            camera->setTarget(value);
+            return true;
+        }
+        return _Reader.skipValue() || fail("The camera is malformed");
+    });
+}
+
+GLboolean SceneLoader::readMaterials(){
+    return readObject([this]() -> GLboolean {
+        const std::string name = _Reader.getString();
+        // the defaults of a material
+        GLfloat ambient = 0.0f, diffuse = 1.0f, specular = 1.0f, shininess = 10.0f;
+        GLboolean isValid = readObject([this, &ambient, &diffuse, &specular, &shininess]() -> GLboolean {
+            if(_Reader.isString("ambient")) return readNumber(ambient);
+            if(_Reader.isString("diffuse")) return readNumber(diffuse);
+            if(_Reader.isString("specular")) return readNumber(specular);
+            if(_Reader.isString("shininess")) return readNumber(shininess);
+            return _Reader.skipValue() || fail("The material is malformed");
+        });
+        if(!isValid) return false;
+        if(ambient < 0.0f || diffuse < 0.0f || specular < 0.0f){
+            fprintf(stderr, "The material %s of %s can't have negative values!\n", name.c_str(), _FileName.c_str());
+            ErrorHandler::handle(ErrorCodes::BAD_VALUE, ErrorLevel::WARNING);
+        }
+        _Materials[name] = MaterialPointer(new Material(ambient, diffuse, specular, shininess));
+        return true;
+    });
+}
+
+GLboolean SceneLoader::readBody(BodyDescription& body){
+    GLboolean hasMeanMotion = false;
+    const GLboolean isValid = readMembers([this, &body, &hasMeanMotion]() -> GLboolean {
+        if(_Reader.isString("name")) return readString(body._Name);
+        if(_Reader.isString("type")){
+            if(_Reader.next() != JSON_STRING) return fail("The body's type must be \"planet\" or \"sun\"");
+            body._IsSun = _Reader.isString("sun");
+            return _Reader.isString("sun") || _Reader.isString("planet") || fail("The body's type must be \"planet\" or \"sun\"");
+        }
+        if(_Reader.isString("material")) return readString(body._Material);
+        if(_Reader.isString("color")) return readVector(body._Color);
+        if(_Reader.isString("texture")) return readString(body._Texture);
+        if(_Reader.isString("size")) return readNumber(body._Size);
+        if(_Reader.isString("rotationSpeed")) return readNumber(body._RotationSpeed);
+        if(_Reader.isString("rotationAxis")) return readVector(body._RotationAxis);
+        if(_Reader.isString("position")) return readVector(body._Position);
+        if(_Reader.isString("orbit")){
+            body._IsKepler = false;
+            return readObject([this, &body]() -> GLboolean {
+                if(_Reader.isString("center")) return readString(body._OrbitCenter);
+                if(_Reader.isString("speed")) return readNumber(body._OrbitSpeed);
+                if(_Reader.isString("axis")) return readVector(body._OrbitAxis);
+                if(_Reader.isString("radius")) return readNumber(body._OrbitRadius);
+                return _Reader.skipValue() || fail("The orbit is malformed");
+            });
+        }
+        if(_Reader.isString("kepler")){
+            body._IsKepler = true;
+            OrbitalElements& elements = body._Elements;
+            return readObject([this, &body, &elements, &hasMeanMotion]() -> GLboolean {
+                if(_Reader.isString("center")) return readString(body._OrbitCenter);
+                if(_Reader.isString("semiMajorAxis")) return readNumber(elements._SemiMajorAxis);
+                if(_Reader.isString("eccentricity")) return readNumber(elements._Eccentricity);
+                if(_Reader.isString("inclination")) return readNumber(elements._Inclination);
+                if(_Reader.isString("ascendingNode")) return readNumber(elements._AscendingNode);
+                if(_Reader.isString("periapsisArgument")) return readNumber(elements._PeriapsisArgument);
+                if(_Reader.isString("meanAnomaly")) return readNumber(elements._MeanAnomaly);
+                if(_Reader.isString("meanMotion")){
+                    hasMeanMotion = true;
+                    return readNumber(elements._MeanMotion);
+                }
+                return _Reader.skipValue() || fail("The Kepler orbit is malformed");
+            });
+        }
+        if(_Reader.isString("light")){
+            return readObject([this, &body]() -> GLboolean {
+                if(_Reader.isString("position")) return readVector(body._LightPosition);
+                if(_Reader.isString("color")) return readVector(body._LightColor);
+                return _Reader.skipValue() || fail("The light is malformed");
+            });
+        }
+        return _Reader.skipValue() || fail("The body is malformed");
+    });
+    if(!isValid) return false;
+
+    // the store stops the program on the values it can't use, they are reported here with their line
+    if(!(body._Size > 0.0f)) return fail("The body's size must be positive");
+    if(body._RotationAxis == glm::vec3(0.0f)) return fail("The body's rotation axis can't be zero");
+    if(body._OrbitCenter.empty()) return true;
+    if(!body._IsKepler){
+        return body._OrbitAxis != glm::vec3(0.0f) || fail("The orbit's axis can't be zero");
+    }
+    const OrbitalElements& elements = body._Elements;
+    if(!(elements._SemiMajorAxis > 0.0f)) return fail("The Kepler orbit's semi-major axis must be positive");
+    if(!(elements._Eccentricity >= 0.0f && elements._Eccentricity < 1.0f)) return fail("The Kepler orbit's eccentricity must be in [0, 1)");
+    return hasMeanMotion || fail("The Kepler orbit needs a mean motion");
+}
+
+GLboolean SceneLoader::readBodies(){
+    if(_Reader.next() != JSON_ARRAY_BEGIN) return fail("An array of bodies is expected");
+    while(true){
+        const JsonToken token = _Reader.next();
+        if(token == JSON_ARRAY_END) return true;
+        if(token != JSON_OBJECT_BEGIN) return fail("A body is expected");
+        BodyDescription body;
+        if(!readBody(body)) return false;
+        createBody(body);
+    }
+}
+
+GLboolean SceneLoader::readEphemeris(){
+    std::string fileName = "";
+    BodyDescription body;
+    GLboolean isValid = readObject([this, &fileName, &body]() -> GLboolean {
+        if(_Reader.isString("file")) return readString(fileName);
+        if(_Reader.isString("material")) return readString(body._Material);
+        if(_Reader.isString("color")) return readVector(body._Color);
+        if(_Reader.isString("size")) return readNumber(body._Size);
+        return _Reader.skipValue() || fail("The ephemeris is malformed");
+    });
+    if(!isValid) return false;
+
+    // a missing ephemeris only leaves its bodies out
+    EphemerisPointer ephemeris = Ephemeris::load(fileName);
+    if(!ephemeris) return true;
+    _Scene->setEphemeris(ephemeris);
+    const MaterialPointer material = getMaterial(body._Material);
+    for(GLuint i=0; i<ephemeris->getNbRecords(); i++){
+        PlanetPointer planet(new Planet(material, _Shader));
+        planet->setColor(body._Color);
+        planet->init(body._Size, body._RotationSpeed, body._RotationAxis, ephemeris, i);
+        planet->addToScene(_Scene);
+    }
+    return true;
+}
+
+GLboolean SceneLoader::readCatalog(){
+    std::string fileName = "";
+    std::string materialName = "";
+    glm::vec4 color = glm::vec4(1.0f);
+    GLboolean isValid = readObject([this, &fileName, &materialName, &color]() -> GLboolean {
+        if(_Reader.isString("file")) return readString(fileName);
+        if(_Reader.isString("material")) return readString(materialName);
+        if(_Reader.isString("color")) return readVector(color);
+        return _Reader.skipValue() || fail("The catalog is malformed");
+    });
+    if(!isValid) return false;
+
+    // a missing catalog only leaves its bodies out
+    _Scene->setCatalog(CatalogLoader::start(fileName, getMaterial(materialName), _Shader, color));
+    return true;
+}
+
+MaterialPointer SceneLoader::getMaterial(const std::string& name){
+    auto material = _Materials.find(name);
+    if(material != _Materials.end()) return material->second;
+    if(!name.empty()){
+        fprintf(stderr, "The material %s isn't described in %s!\n", name.c_str(), _FileName.c_str());
+        ErrorHandler::handle(ErrorCodes::BAD_VALUE, ErrorLevel::WARNING);
+    }
+    // the unknown names share the default material from now on
+    MaterialPointer defaultMaterial(new Material());
+    _Materials[name] = defaultMaterial;
+    return defaultMaterial;
+}
+
+void SceneLoader::createBody(const BodyDescription& body){
+    const MaterialPointer material = getMaterial(body._Material);
+    PlanetPointer planet = body._IsSun ? PlanetPointer(new Sun(material, _Shader, body._LightPosition, body._LightColor))
+                                       : PlanetPointer(new Planet(material, _Shader));
+    planet->setColor(body._Color);
+
+    auto center = body._OrbitCenter.empty() ? _Bodies.end() : _Bodies.find(body._OrbitCenter);
+    if(!body._OrbitCenter.empty() && center == _Bodies.end()){
+        fprintf(stderr, "The orbit center %s must be described before its satellites in %s!\n", body._OrbitCenter.c_str(), _FileName.c_str());
+        ErrorHandler::handle(ErrorCodes::BAD_VALUE, ErrorLevel::WARNING);
+    }
+    if(center == _Bodies.end()){
+        planet->init(body._Size, body._RotationSpeed, body._RotationAxis, body._Position);
+    } else if(body._IsKepler){
+        planet->init(body._Size, body._RotationSpeed, body._RotationAxis, body._Elements, center->second);
+    } else {
+        planet->init(body._Size, body._RotationSpeed, body._RotationAxis,
+                        body._OrbitSpeed, body._OrbitAxis, body._OrbitRadius, center->second);
+    }
+    planet->addToScene(_Scene);
+    if(!body._Texture.empty()) planet->loadTexture(body._Texture);
+    if(!body._Name.empty()) _Bodies[body._Name] = planet;
+}
+
+ScenePointer SceneLoader::load(const std::string& fileName, CameraPointer& camera, const ShadersPointer& shader){
+    SceneLoader loader(fileName, shader);
+    if(!loader._Reader.open(fileName)){
+        fprintf(stderr, "Failed to read the file: %s!\n", fileName.c_str());
+        ErrorHandler::handle(ErrorCodes::READ_FILE_ERROR, ErrorLevel::WARNING);
+        return nullptr;
+    }
+    loader._Scene = ScenePointer(new Scene(camera));
+
+    GLboolean isValid = loader.readObject([&loader, &camera]() -> GLboolean {
+        if(loader._Reader.isString("camera")) return loader.readCamera(camera);
+        if(loader._Reader.isString("materials")) return loader.readMaterials();
+        if(loader._Reader.isString("bodies")) return loader.readBodies();
+        if(loader._Reader.isString("ephemeris")) return loader.readEphemeris();
+        if(loader._Reader.isString("catalog")) return loader.readCatalog();
+        return loader._Reader.skipValue() || loader.fail("The scene is malformed");
+    });
+    if(isValid && loader._Reader.next() != JSON_END) isValid = loader.fail("Nothing can follow the scene");
+    if(!isValid){
+        ErrorHandler::handle(ErrorCodes::BAD_VALUE, ErrorLevel::WARNING);
+        return nullptr;
+    }
+    return loader._Scene;
+}
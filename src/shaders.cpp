@@ -1,6 +1,9 @@
 #include "shaders.hpp"
 #include <cstdlib>
 #include <fstream>
+#include <vector>
+
+GLuint Shaders::_CurrentId = 0;
 
 Shaders::Shaders(const std::string& vert, const std::string& frag, const std::string& geom){
     _Id = glCreateProgram();
@@ -23,8 +26,10 @@ Shaders::Shaders(const std::string& vert, const std::string& frag, const std::st
 }
 
 void Shaders::use() const {
+    if(_CurrentId == _Id) return;
     checkID("Can't use the shader before creating the program!\n");
     glUseProgram(_Id);
+    _CurrentId = _Id;
 }
 
 
@@ -101,4 +106,41 @@ void Shaders::linkShaders(GLuint vert, GLuint frag, GLuint geom){
         fprintf(stderr, "Failed to link the shaders:\n\t%s\n", infoLog);
         ErrorHandler::handle(ErrorCodes::LINK_ERROR);
     }
-}
\ No newline at end of file
+
+    introspectUniforms();
+    bindUniformBlock(kFrameBlockName, UniformBinding::FRAME_BINDING);
+    bindUniformBlock(kLightsBlockName, UniformBinding::LIGHTS_BINDING);
+}
+
+void Shaders::introspectUniforms(){
+    GLint nbUniforms = 0;
+    GLint maxLength = 0;
+    glGetProgramiv(_Id, GL_ACTIVE_UNIFORMS, &nbUniforms);
+    glGetProgramiv(_Id, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+    std::vector<GLchar> nameBuffer(maxLength+1);
+
+    _Uniforms.clear();
+    for(GLint i=0; i<nbUniforms; i++){
+        GLsizei length = 0;
+        GLint size = 0;
+        GLenum type = GL_NONE;
+        glGetActiveUniform(_Id, i, nameBuffer.size(), &length, &size, &type, nameBuffer.data());
+        std::string name(nameBuffer.data(), length);
+
+        GLint location = glGetUniformLocation(_Id, name.c_str());
+        // uniform block members don't have a location
+        if(location == -1) continue;
+        _Uniforms[name] = {location, type};
+
+        // arrays of basic types are reported once as "name[0]"
+        const std::string suffix = "[0]";
+        if(name.size() > suffix.size() && name.compare(name.size()-suffix.size(), suffix.size(), suffix) == 0){
+            std::string base = name.substr(0, name.size()-suffix.size());
+            _Uniforms[base] = {location, type};
+            for(GLint j=1; j<size; j++){
+                std::string element = base + "[" + std::to_string(j) + "]";
+                _Uniforms[element] = {glGetUniformLocation(_Id, element.c_str()), type};
+            }
+        }
+    }
+}
@@ -0,0 +1,271 @@
+#include "textureManager.hpp"
+#include "errorHandler.hpp"
+#include "stb_image.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+TextureManagerPointer TextureManager::_Instance = TextureManagerPointer(nullptr);
+
+namespace {
+
+/**
+ * Get the OpenGL magnifying filter of a filtering
+ * @param filter The filtering
+ * @return The OpenGL filter
+*/
+GLint toGL(Filtering filter){
+    switch(filter){
+        case NEAREST:
+            return GL_NEAREST;
+        case LINEAR:
+        default:
+            return GL_LINEAR;
+    }
+}
+
+/**
+ * Get the OpenGL minifying filter of a filtering, reading the mip levels
+ * @param filter The filtering
+ * @return The OpenGL filter
+*/
+GLint toGLMipmap(Filtering filter){
+    switch(filter){
+        case NEAREST:
+            return GL_NEAREST_MIPMAP_NEAREST;
+        case LINEAR:
+        default:
+            return GL_LINEAR_MIPMAP_LINEAR;
+    }
+}
+
+/**
+ * Get the OpenGL wrap mode of a wrapping
+ * @param wrap The wrapping
+ * @return The OpenGL wrap mode
+*/
+GLint toGL(Wrapping wrap){
+    switch(wrap){
+        case MIRRORED_REPEAT:
+            return GL_MIRRORED_REPEAT;
+        case CLAMP_TO_EDGE:
+            return GL_CLAMP_TO_EDGE;
+        case CLAMP_TO_BORDER:
+            return GL_CLAMP_TO_BORDER;
+        case REPEAT:
+        default:
+            return GL_REPEAT;
+    }
+}
+
+/**
+ * Get the size of a decoded image
+ * @param upload The loading
+ * @return The size, in bytes
+*/
+std::size_t getImageSize(const TextureUpload& upload){
+    return (std::size_t)upload._Width * upload._Height * upload._NbChannels;
+}
+
+}
+
+void Texture::upload(GLsizei width, GLsizei height, GLint nbChannels, const void* pixels){
+    GLuint id = 0;
+    glGenTextures(1, &id);
+    glBindTexture(GL_TEXTURE_2D, id);
+    // the rows of an rgb image aren't aligned on 4 bytes
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    const GLenum internalFormat = nbChannels == 4 ? GL_RGBA8 : GL_RGB8;
+    const GLenum format = nbChannels == 4 ? GL_RGBA : GL_RGB;
+#ifdef GL_VERSION_4_2
+    if(GLAD_GL_VERSION_4_2){
+        // immutable storage of the full chain down to 1x1, the levels are allocated once
+        GLsizei nbLevels = 1;
+        while((std::max(width, height) >> nbLevels) > 0) nbLevels++;
+        glTexStorage2D(GL_TEXTURE_2D, nbLevels, internalFormat, width, height);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, format, GL_UNSIGNED_BYTE, pixels);
+    } else
+#endif
+    {
+        glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, GL_UNSIGNED_BYTE, pixels);
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glGenerateMipmap(GL_TEXTURE_2D);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    _Id = id;
+}
+
+Sampler::Sampler(Filtering minFilter, Filtering magFilter, Wrapping wrapS, Wrapping wrapT, GLfloat anisotropy){
+    glGenSamplers(1, &_Id);
+    glSamplerParameteri(_Id, GL_TEXTURE_MIN_FILTER, toGLMipmap(minFilter));
+    glSamplerParameteri(_Id, GL_TEXTURE_MAG_FILTER, toGL(magFilter));
+    glSamplerParameteri(_Id, GL_TEXTURE_WRAP_S, toGL(wrapS));
+    glSamplerParameteri(_Id, GL_TEXTURE_WRAP_T, toGL(wrapT));
+#ifdef GL_EXT_texture_filter_anisotropic
+    if(anisotropy > 1.0f) glSamplerParameterf(_Id, GL_TEXTURE_MAX_ANISOTROPY_EXT, anisotropy);
+#endif
+}
+
+TextureManager::TextureManager(GLuint nbWorkers){
+    for(GLuint i=0; i<nbWorkers; i++){
+        _Workers.emplace_back(&TextureManager::work, this);
+    }
+}
+
+TextureManager::~TextureManager(){
+    {
+        std::lock_guard<std::mutex> lock(_Mutex);
+        _IsStopping = true;
+    }
+    _WakeUp.notify_all();
+    for(auto& worker : _Workers){
+        worker.join();
+    }
+    // the pixel buffers go with the context
+    for(auto& upload : _Jobs){
+        if(upload->_Pixels) stbi_image_free(upload->_Pixels);
+    }
+    for(auto& upload : _Finished){
+        if(upload->_Pixels) stbi_image_free(upload->_Pixels);
+    }
+}
+
+void TextureManager::work(){
+    while(true){
+        TextureUploadPointer upload;
+        {
+            std::unique_lock<std::mutex> lock(_Mutex);
+            _WakeUp.wait(lock, [this](){ return _IsStopping || !_Jobs.empty(); });
+            if(_IsStopping) return;
+            upload = _Jobs.front();
+            _Jobs.pop_front();
+        }
+
+        if(upload->_Stage == DECODING){
+            // the rgb images stay rgb, the others are expanded to rgba
+            const char* fileName = upload->_Texture->getFileName().c_str();
+            int width = 0, height = 0, nbChannels = 0;
+            if(stbi_info(fileName, &width, &height, &nbChannels)){
+                const int nbWanted = nbChannels == 3 || nbChannels == 1 ? 3 : 4;
+                upload->_Pixels = stbi_load(fileName, &width, &height, &nbChannels, nbWanted);
+                upload->_Width = width;
+                upload->_Height = height;
+                upload->_NbChannels = nbWanted;
+            }
+            upload->_Stage = DECODED;
+        } else {
+            memcpy(upload->_Mapping, upload->_Pixels, getImageSize(*upload));
+            upload->_Stage = COPIED;
+        }
+
+        std::lock_guard<std::mutex> lock(_Mutex);
+        _Finished.push_back(upload);
+    }
+}
+
+void TextureManager::submit(const TextureUploadPointer& upload){
+    {
+        std::lock_guard<std::mutex> lock(_Mutex);
+        _Jobs.push_back(upload);
+    }
+    _WakeUp.notify_one();
+}
+
+TexturePointer TextureManager::load(const std::string& fileName){
+    TexturePointer texture = _Textures[fileName].lock();
+    if(texture) return texture;
+
+    texture = TexturePointer(new Texture(fileName));
+    _Textures[fileName] = texture;
+    TextureUploadPointer upload(new TextureUpload());
+    upload->_Texture = texture;
+    _NbPending++;
+    submit(upload);
+    return texture;
+}
+
+SamplerPointer TextureManager::getSampler(Filtering minFilter, Filtering magFilter, Wrapping wrapS, Wrapping wrapT){
+    const GLuint key = minFilter | magFilter << 2 | wrapS << 4 | wrapT << 6;
+    SamplerPointer sampler = _Samplers[key].lock();
+    if(sampler) return sampler;
+
+    if(_Anisotropy == 0.0f){
+        _Anisotropy = 1.0f;
+#ifdef GL_EXT_texture_filter_anisotropic
+        if(GLAD_GL_EXT_texture_filter_anisotropic){
+            GLfloat largest = 1.0f;
+            glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT, &largest);
+            _Anisotropy = std::min(kMaxAnisotropy, largest);
+        }
+#endif
+    }
+    // the nearest filter keeps its blocky look, without anisotropy
+    sampler = SamplerPointer(new Sampler(minFilter, magFilter, wrapS, wrapT, minFilter == LINEAR ? _Anisotropy : 1.0f));
+    _Samplers[key] = sampler;
+    return sampler;
+}
+
+void TextureManager::map(const TextureUploadPointer& upload){
+    const GLsizeiptr size = getImageSize(*upload);
+    glGenBuffers(1, &upload->_Buffer);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, upload->_Buffer);
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, size, nullptr, GL_STREAM_DRAW);
+    upload->_Mapping = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    if(upload->_Mapping){
+        // a worker copies the pixels while the frames go on
+        upload->_Stage = COPYING;
+        submit(upload);
+        return;
+    }
+
+    glDeleteBuffers(1, &upload->_Buffer);
+    upload->_Buffer = 0;
+    upload->_Texture->upload(upload->_Width, upload->_Height, upload->_NbChannels, upload->_Pixels);
+    stbi_image_free(upload->_Pixels);
+    upload->_Pixels = nullptr;
+    _NbPending--;
+}
+
+void TextureManager::unmap(const TextureUploadPointer& upload){
+    stbi_image_free(upload->_Pixels);
+    upload->_Pixels = nullptr;
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, upload->_Buffer);
+    const GLboolean isIntact = glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+    if(isIntact){
+        // the transfer runs from the buffer, the buffer is released once it is done
+        upload->_Texture->upload(upload->_Width, upload->_Height, upload->_NbChannels, nullptr);
+    } else {
+        fprintf(stderr, "The pixel buffer of the texture %s has been lost!\n", upload->_Texture->getFileName().c_str());
+        ErrorHandler::handle(ErrorCodes::GL_ERROR, ErrorLevel::WARNING);
+        upload->_Texture->_IsFailed = true;
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    glDeleteBuffers(1, &upload->_Buffer);
+    upload->_Buffer = 0;
+    _NbPending--;
+}
+
+void TextureManager::update(){
+    std::vector<TextureUploadPointer> finished;
+    {
+        std::lock_guard<std::mutex> lock(_Mutex);
+        if(_Finished.empty()) return;
+        finished.swap(_Finished);
+    }
+
+    for(const auto& upload : finished){
+        if(upload->_Stage == COPIED){
+            unmap(upload);
+            continue;
+        }
+        if(!upload->_Pixels){
+            fprintf(stderr, "Failed to load the texture: %s!\n", upload->_Texture->getFileName().c_str());
+            ErrorHandler::handle(ErrorCodes::READ_FILE_ERROR, ErrorLevel::WARNING);
+            upload->_Texture->_IsFailed = true;
+            _NbPending--;
+            continue;
+        }
+        map(upload);
+    }
+}
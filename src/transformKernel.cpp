@@ -0,0 +1,121 @@
+#include "transformKernel.hpp"
+#include "transformKernelImpl.hpp"
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#endif
+
+namespace {
+
+/**
+ * The number of Newton iterations solving Kepler's equation in double precision
+*/
+const static int kKeplerIterationsDouble = 10;
+
+/**
+ * Solve Kepler's equation E - e sin(E) = M in double precision
+ * @param meanAnomaly The mean anomaly M, in [-pi, pi)
+ * @param eccentricity The eccentricity e, in [0, 1)
+ * @return The eccentric anomaly E
+*/
+GLdouble solveKeplerDouble(GLdouble meanAnomaly, GLdouble eccentricity){
+    GLdouble anomaly = meanAnomaly + std::copysign(0.85, meanAnomaly) * eccentricity;
+    for(int i=0; i<kKeplerIterationsDouble; i++){
+        GLdouble delta = (anomaly - eccentricity * std::sin(anomaly) - meanAnomaly) / (1.0 - eccentricity * std::cos(anomaly));
+        anomaly -= delta;
+        if(std::abs(delta) < 1e-15) break;
+    }
+    return anomaly;
+}
+
+/**
+ * Tell if the processor and the system support AVX2 and FMA
+ * @return True if the AVX2 kernel can run
+*/
+bool supportsAvx2(){
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    int info[4];
+    __cpuid(info, 0);
+    if(info[0] < 7) return false;
+    __cpuid(info, 1);
+    const bool fma = (info[2] & (1 << 12)) != 0;
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    if(!fma || !osxsave || (_xgetbv(0) & 0x6) != 0x6) return false;
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return false;
+#endif
+}
+
+}
+
+SimdLevel detectSimdLevel(){
+    static const SimdLevel level = [](){
+        TransformBatch empty = {};
+        // the avx2 kernel reports if it was compiled in
+        if(supportsAvx2() && buildTransformsAvx2(empty, 0.0f, 0, 0)) return SIMD_AVX2;
+#ifdef SIMD_LANES_SSE
+        return SIMD_SSE;
+#else
+        return SIMD_SCALAR;
+#endif
+    }();
+    return level;
+}
+
+void buildTransforms(const TransformBatch& batch, GLdouble time, GLuint first, GLuint last, SimdLevel level){
+    if(level > detectSimdLevel()) level = detectSimdLevel();
+    switch(level){
+        case SIMD_AVX2:
+            if(buildTransformsAvx2(batch, time, first, last)) return;
+            // fall through
+        case SIMD_SSE:
+#ifdef SIMD_LANES_SSE
+            buildRange<SseLanes>(batch, time, first, last);
+            return;
+#endif
+            // fall through
+        case SIMD_SCALAR:
+        default:
+            buildRange<ScalarLanes>(batch, time, first, last);
+            return;
+    }
+}
+
+void buildPositions(const TransformBatch& batch, GLdouble time, GLuint first, GLuint last){
+    const GLdouble pi = 3.141592653589793;
+    for(GLuint i=first; i<last; i++){
+        const GLint p = batch._Parents[i];
+        if(p < 0){
+            batch._Positions[i] = glm::dvec3(batch._OriginsX[i], batch._OriginsY[i], batch._OriginsZ[i]);
+            continue;
+        }
+
+        // R(orbit) * (radius, 0, 0) = radius (cos(a) x + sin(a) axis ^ x + (1 - cos(a)) axis.x axis)
+        const glm::dvec3 axis(batch._OrbitAxesX[i], batch._OrbitAxesY[i], batch._OrbitAxesZ[i]);
+        const GLdouble angle = batch._OrbitSpeeds[i] * time;
+        const GLdouble c = std::cos(angle), s = std::sin(angle);
+        glm::dvec3 offset = (GLdouble)batch._OrbitRadii[i] * (glm::dvec3(c, s * axis.z, -s * axis.y) + ((1.0 - c) * axis.x) * axis);
+
+        // the Kepler orbit, a (cos(E) - e) along the periapsis and b sin(E) ahead of it
+        const glm::dvec3 periapsis(batch._PeriapsesX[i], batch._PeriapsesY[i], batch._PeriapsesZ[i]);
+        if(periapsis != glm::dvec3(0.0)){
+            const glm::dvec3 semiMinor(batch._SemiMinorAxesX[i], batch._SemiMinorAxesY[i], batch._SemiMinorAxesZ[i]);
+            const GLdouble eccentricity = batch._Eccentricities[i];
+            GLdouble meanAnomaly = batch._MeanAnomalies[i] + batch._MeanMotions[i] * time;
+            meanAnomaly -= 2.0 * pi * std::floor((meanAnomaly + pi) / (2.0 * pi));
+            const GLdouble anomaly = solveKeplerDouble(meanAnomaly, eccentricity);
+            offset += (std::cos(anomaly) - eccentricity) * periapsis + std::sin(anomaly) * semiMinor;
+        }
+
+        // the offset is in the orbit center's frame, rotated and scaled by it
+        const glm::mat4& frame = batch._Frames[p];
+        batch._Positions[i] = batch._Positions[p] + glm::dvec3(glm::vec3(frame[0])) * offset.x
+                                                  + glm::dvec3(glm::vec3(frame[1])) * offset.y
+                                                  + glm::dvec3(glm::vec3(frame[2])) * offset.z;
+    }
+}
@@ -0,0 +1,165 @@
+#include "vertexFormat.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+namespace {
+
+/**
+ * Get the size in bytes of an encoded attribute, padded to 4 bytes
+ * @param attribute The attribute
+ * @return The size in bytes
+*/
+GLuint getEncodedSize(const AttributeFormat& attribute){
+    GLuint size = 0;
+    switch(attribute._Encoding){
+        case FLOAT32:
+            size = 4*attribute._Components;
+            break;
+        case FLOAT16:
+            size = 2*attribute._Components;
+            break;
+        case UNORM8:
+            size = attribute._Components;
+            break;
+        case SNORM_10_10_10_2:
+            size = 4;
+            break;
+    }
+    return (size + 3) & ~3u;
+}
+
+/**
+ * Convert a float to a half float, rounding to the nearest
+ * @param value The float
+ * @return The half float bits
+*/
+uint16_t toHalf(GLfloat value){
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    const uint32_t sign = (bits >> 16) & 0x8000u;
+    const int32_t exponent = (int32_t)((bits >> 23) & 0xffu) - 127 + 15;
+    uint32_t mantissa = bits & 0x7fffffu;
+
+    // nan and infinity
+    if(((bits >> 23) & 0xffu) == 0xffu) return sign | 0x7c00u | (mantissa ? 0x200u : 0u);
+    // overflow
+    if(exponent >= 31) return sign | 0x7c00u;
+    // underflow to subnormals or zero
+    if(exponent <= 0){
+        if(exponent < -10) return sign;
+        mantissa |= 0x800000u;
+        const uint32_t shift = 14 - exponent;
+        uint32_t half = mantissa >> shift;
+        if((mantissa >> (shift-1)) & 1u) half++;
+        return sign | half;
+    }
+    uint32_t half = sign | ((uint32_t)exponent << 10) | (mantissa >> 13);
+    // round to nearest, the carry correctly bumps the exponent
+    if(mantissa & 0x1000u) half++;
+    return half;
+}
+
+/**
+ * Convert a float in [-1, 1] to a signed normalized integer
+ * @param value The float
+ * @param maxValue The largest positive integer
+ * @return The integer
+*/
+int32_t toSnorm(GLfloat value, int32_t maxValue){
+    value = std::min(1.0f, std::max(-1.0f, value));
+    return (int32_t)std::lround(value * maxValue);
+}
+
+}
+
+VertexFormat::VertexFormat(std::initializer_list<AttributeFormat> attributes)
+    : _Attributes(attributes){
+    for(auto& attribute : _Attributes){
+        attribute._Offset = _Stride;
+        _Stride += getEncodedSize(attribute);
+        _NbComponents += attribute._Components;
+    }
+}
+
+VertexBytes VertexFormat::encode(const GLfloat* source, GLuint nbVertices) const {
+    VertexBytes bytes = VertexBytes((size_t)nbVertices*_Stride, 0);
+    for(GLuint i=0; i<nbVertices; i++){
+        GLubyte* vertex = &bytes[(size_t)i*_Stride];
+        for(const auto& attribute : _Attributes){
+            GLubyte* destination = vertex + attribute._Offset;
+            switch(attribute._Encoding){
+                case FLOAT32:
+                    memcpy(destination, source, attribute._Components*sizeof(GLfloat));
+                    break;
+                case FLOAT16:
+                    for(GLint c=0; c<attribute._Components; c++){
+                        uint16_t half = toHalf(source[c]);
+                        memcpy(destination + 2*c, &half, sizeof(half));
+                    }
+                    break;
+                case UNORM8:
+                    for(GLint c=0; c<attribute._Components; c++){
+                        GLfloat value = std::min(1.0f, std::max(0.0f, source[c]));
+                        destination[c] = (GLubyte)std::lround(value * 255.0f);
+                    }
+                    break;
+                case SNORM_10_10_10_2:{
+                    uint32_t packed = 0;
+                    for(GLint c=0; c<attribute._Components && c<3; c++){
+                        packed |= ((uint32_t)toSnorm(source[c], 511) & 0x3ffu) << (10*c);
+                    }
+                    memcpy(destination, &packed, sizeof(packed));
+                    break;
+                }
+            }
+            source += attribute._Components;
+        }
+    }
+    return bytes;
+}
+
+void VertexFormat::bindAttributes() const {
+    for(const auto& attribute : _Attributes){
+        GLvoid* pointer = reinterpret_cast<GLvoid*>((uintptr_t)attribute._Offset);
+        switch(attribute._Encoding){
+            case FLOAT32:
+                glVertexAttribPointer(attribute._Location, attribute._Components, GL_FLOAT, GL_FALSE, _Stride, pointer);
+                break;
+            case FLOAT16:
+                glVertexAttribPointer(attribute._Location, attribute._Components, GL_HALF_FLOAT, GL_FALSE, _Stride, pointer);
+                break;
+            case UNORM8:
+                glVertexAttribPointer(attribute._Location, attribute._Components, GL_UNSIGNED_BYTE, GL_TRUE, _Stride, pointer);
+                break;
+            case SNORM_10_10_10_2:
+                // packed formats are always read as 4 components
+                glVertexAttribPointer(attribute._Location, 4, GL_INT_2_10_10_10_REV, GL_TRUE, _Stride, pointer);
+                break;
+        }
+        glEnableVertexAttribArray(attribute._Location);
+    }
+}
+
+VertexFormat VertexFormat::standard(){
+    return VertexFormat({
+        {VERTEX_POSITION, 3, FLOAT32},
+        {VERTEX_UV, 2, FLOAT32},
+        {VERTEX_NORMAL, 3, FLOAT32},
+    });
+}
+
+VertexFormat VertexFormat::packed(){
+    return VertexFormat({
+        {VERTEX_POSITION, 3, FLOAT32},
+        {VERTEX_UV, 2, FLOAT16},
+        {VERTEX_NORMAL, 3, SNORM_10_10_10_2},
+    });
+}
+
+VertexFormat VertexFormat::colors(){
+    return VertexFormat({
+        {VERTEX_COLOR, 4, UNORM8},
+    });
+}